@@ -0,0 +1,194 @@
+/// @file
+/// Monotonic arena and a stateful allocator that draws from it.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// Geometry read from a file is allocated once and then lives as long as
+/// its FarmDb, so a bump allocator over large blocks avoids millions of
+/// small heap allocations and keeps coordinates contiguous.  A default
+/// constructed ArenaAllocator uses whatever arena the current thread has
+/// selected with ArenaScope, or the heap when there is none; containers
+/// therefore pick up the arena without any change to the code that builds
+/// them.  An Arena is not thread safe; worker threads see no scope and so
+/// allocate from the heap.
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+namespace tjg {
+
+class Arena {
+  struct Block {
+    std::unique_ptr<std::byte[]> data;
+    std::size_t size;
+  }; // Block
+
+  std::vector<Block> _blocks;
+  std::byte*  _ptr  = nullptr;  // next free byte in the current block
+  std::byte*  _end  = nullptr;
+  std::byte*  _last = nullptr;  // most recent allocation, for rewinding
+  std::size_t _blockSize;
+  std::size_t _used = 0;
+  std::vector<std::unique_ptr<Arena>> _children;
+
+  static Arena*& CurrentRef() noexcept {
+    thread_local Arena* current = nullptr;
+    return current;
+  } // CurrentRef
+
+  friend class ArenaScope;
+
+  void* fresh(std::size_t bytes, std::size_t align) {
+    // Large requests get their own block so they do not waste the tail of
+    // the current one.
+    const auto size = std::max(bytes + align, _blockSize);
+    auto& b = _blocks.emplace_back(
+                  Block{std::make_unique_for_overwrite<std::byte[]>(size), size});
+    auto p = static_cast<void*>(b.data.get());
+    auto space = size;
+    p = std::align(align, bytes, p, space);
+    auto bp = static_cast<std::byte*>(p);
+    if (size == _blockSize || _ptr == nullptr) {
+      _ptr = bp + bytes;
+      _end = b.data.get() + size;
+      _last = bp;
+    }
+    return p;
+  } // fresh
+
+public:
+  static constexpr std::size_t DefaultBlockSize = 1024 * 1024;
+
+  explicit Arena(std::size_t blockSize = DefaultBlockSize) noexcept
+    : _blockSize{blockSize} { }
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /// The arena selected by the innermost ArenaScope on this thread.
+  static Arena* Current() noexcept { return CurrentRef(); }
+
+  void* allocate(std::size_t bytes, std::size_t align) {
+    _used += bytes;
+    auto space = static_cast<std::size_t>(_end - _ptr);
+    auto p = static_cast<void*>(_ptr);
+    if (_ptr && std::align(align, bytes, p, space)) {
+      _last = static_cast<std::byte*>(p);
+      _ptr  = _last + bytes;
+      return p;
+    }
+    return fresh(bytes, align);
+  } // allocate
+
+  /// Memory is reclaimed only when the arena is destroyed, except that
+  /// freeing the most recent allocation rewinds, so a temporary freed
+  /// before anything else is allocated costs nothing.  A growing vector
+  /// gets no such reuse, since it allocates its new buffer before freeing
+  /// the old one; containers built in an arena should be sized before they
+  /// are filled.
+  void deallocate(void* p, std::size_t bytes) noexcept {
+    _used -= bytes;
+    if (p == _last && _last + bytes == _ptr) {
+      _ptr  = _last;
+      _last = nullptr;
+    }
+  } // deallocate
+
+  /// A new arena that lives exactly as long as this one, so a worker
+  /// thread can build geometry that is then owned alongside this arena's.
+  /// Creating children is not thread safe; each may be used by a different
+  /// thread.
+  Arena& child() {
+    return *_children.emplace_back(std::make_unique<Arena>(_blockSize));
+  } // child
+
+  /// Bytes currently handed out, children included.
+  std::size_t used() const noexcept {
+    auto n = _used;
+    for (const auto& c: _children)
+      n += c->used();
+    return n;
+  } // used
+
+  /// Bytes reserved from the heap, children included.
+  std::size_t capacity() const noexcept {
+    auto n = std::size_t{0};
+    for (const auto& b: _blocks)
+      n += b.size;
+    for (const auto& c: _children)
+      n += c->capacity();
+    return n;
+  } // capacity
+}; // Arena
+
+/// Selects `arena` for default-constructed ArenaAllocators on this thread
+/// until the scope ends.
+class ArenaScope {
+  Arena* _prev;
+
+public:
+  explicit ArenaScope(Arena* arena) noexcept
+    : _prev{std::exchange(Arena::CurrentRef(), arena)} { }
+  explicit ArenaScope(Arena& arena) noexcept : ArenaScope{&arena} { }
+
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+
+  ~ArenaScope() noexcept { Arena::CurrentRef() = _prev; }
+}; // ArenaScope
+
+template<class T>
+class ArenaAllocator {
+  Arena* _arena;
+
+  template<class U> friend class ArenaAllocator;
+
+public:
+  using value_type = T;
+
+  // Containers keep the arena they were built in when moved or swapped; a
+  // copy follows the scope in effect where it is made.
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap            = std::true_type;
+  using is_always_equal                        = std::false_type;
+
+  ArenaAllocator() noexcept : _arena{Arena::Current()} { }
+  explicit ArenaAllocator(Arena* arena) noexcept : _arena{arena} { }
+
+  template<class U>
+  ArenaAllocator(const ArenaAllocator<U>& rhs) noexcept : _arena{rhs._arena} { }
+
+  ArenaAllocator select_on_container_copy_construction() const noexcept
+    { return ArenaAllocator{}; }
+
+  Arena* arena() const noexcept { return _arena; }
+
+  T* allocate(std::size_t n) {
+    if (!_arena)
+      return std::allocator<T>{}.allocate(n);
+    if (n > static_cast<std::size_t>(-1) / sizeof(T))
+      throw std::bad_array_new_length{};
+    return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+  } // allocate
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    if (!_arena)
+      std::allocator<T>{}.deallocate(p, n);
+    else
+      _arena->deallocate(p, n * sizeof(T));
+  } // deallocate
+
+  template<class U>
+  friend bool operator==(const ArenaAllocator& lhs,
+                         const ArenaAllocator<U>& rhs) noexcept
+    { return lhs._arena == rhs.arena(); }
+}; // ArenaAllocator
+
+} // tjg
@@ -0,0 +1,384 @@
+/// @file
+/// Times each stage of the read -> inset -> write pipeline.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// Runs on synthetic fields of chosen vertex and hole counts and on any
+/// fixture files given on the command line.  One CSV row per stage goes to
+/// stdout so runs can be compared between releases; progress goes to stderr.
+
+#include "FarmDb.hpp"
+#include "FarmGeo.hpp"
+#include "BoundarySwaths.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <numbers>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+
+namespace po = boost::program_options;
+namespace fs = std::filesystem;
+
+using namespace farm_db;
+
+namespace {
+
+struct Options {
+  std::vector<int> vertices;
+  std::vector<int> holes;
+  int fields = 16;
+  int reps   = 5;
+  double insetM = 10.0;
+  std::vector<fs::path> fixtures;
+  fs::path workDir;
+}; // Options
+
+std::optional<Options> ParseArgs(int argc, const char* argv[]) {
+  auto opts = Options{};
+
+  auto desc = po::options_description("Options");
+  desc.add_options()
+    ("help,h", "Show help.")
+    ("vertices,v", po::value<std::vector<int>>(&opts.vertices),
+      "Outer ring vertex count of the synthetic fields; repeatable "
+      "(default: 64, 1024, 16384).")
+    ("holes,k", po::value<std::vector<int>>(&opts.holes),
+      "Hole count of the synthetic fields; repeatable (default: 0, 8).")
+    ("fields,f", po::value<int>(&opts.fields)->default_value(16),
+      "Synthetic fields per case (default: 16).")
+    ("reps,r", po::value<int>(&opts.reps)->default_value(5),
+      "Repetitions of each stage (default: 5).")
+    ("inset,d", po::value<double>(&opts.insetM)->default_value(10.0),
+      "Inset distance in metres (default: 10).")
+    ("fixture,x", po::value<std::vector<fs::path>>(&opts.fixtures),
+      "Also benchmark this .xml, .shp, .zip or .fdb file; repeatable.")
+    ("dir", po::value<fs::path>(&opts.workDir),
+      "Directory for the files written (default: a temp directory).");
+
+  auto positional = po::positional_options_description{};
+  positional.add("fixture", -1);
+
+  auto vm = po::variables_map{};
+  try {
+    po::store(po::command_line_parser(argc, argv)
+                .options(desc).positional(positional).run(), vm);
+    if (vm.count("help") != 0U) {
+      std::cout << "Usage:\n  Bench [options] [fixture...]\n\n" << desc
+                << "\nColumns: case,stage,reps,items,min_ms,median_ms,"
+                   "mean_ms\n";
+      return std::nullopt;
+    }
+    po::notify(vm);
+  }
+  catch (const po::error& e) {
+    std::cerr << "Command line error: " << e.what() << "\n\n" << desc << '\n';
+    std::exit(2);
+  }
+
+  if (opts.vertices.empty())
+    opts.vertices = {64, 1024, 16384};
+  if (opts.holes.empty())
+    opts.holes = {0, 8};
+  if (opts.fields < 1 || opts.reps < 1 || opts.insetM <= 0.0) {
+    std::cerr << "Error: fields and reps must be >= 1, inset > 0.\n";
+    std::exit(2);
+  }
+  for (auto v: opts.vertices) {
+    if (v < 8) {
+      std::cerr << "Error: vertex count must be >= 8.\n";
+      std::exit(2);
+    }
+  }
+  for (auto h: opts.holes) {
+    if (h < 0) {
+      std::cerr << "Error: hole count must be >= 0.\n";
+      std::exit(2);
+    }
+  }
+  if (opts.workDir.empty())
+    opts.workDir = fs::temp_directory_path() / "farmdb_bench";
+  fs::create_directories(opts.workDir);
+  return opts;
+} // ParseArgs
+
+// ---- Synthetic fields ----
+
+constexpr auto MetresPerDegree = 111'320.0;
+
+/// Appends a closed circle of `n` vertices, radius `r` metres, centred
+/// `(x, y)` metres from `centre`; clockwise unless `ccw`.
+void AppendCircle(Coords& ring, const LatLon& centre, double x, double y,
+                  double r, int n, bool ccw, double wobble)
+{
+  using std::numbers::pi;
+  const auto lat0 = centre.lat();
+  const auto lon0 = centre.lon();
+  const auto mPerLon = MetresPerDegree * std::cos(lat0 * pi / 180.0);
+  ring.reserve(ring.size() + static_cast<std::size_t>(n) + 1);
+  for (int i = 0; i <= n; ++i) {
+    const auto k = (i == n) ? 0 : i;
+    const auto a = (ccw ? 1.0 : -1.0) * 2.0 * pi * k / n;
+    const auto ri = r * (1.0 + wobble * std::sin(7.0 * a));
+    const auto px = x + ri * std::cos(a);
+    const auto py = y + ri * std::sin(a);
+    ring.emplace_back((lat0 + py / MetresPerDegree) * units::deg,
+                      (lon0 + px / mPerLon)         * units::deg);
+  }
+} // AppendCircle
+
+/// A wobbly disc of radius 400 m with `nHoles` round holes on a grid.
+Polygon MakePart(const LatLon& centre, int nVertices, int nHoles) {
+  constexpr auto Radius = 400.0;
+  auto poly = Polygon{};
+  AppendCircle(poly.outer(), centre, 0.0, 0.0, Radius, nVertices, false, 0.05);
+  if (nHoles == 0)
+    return poly;
+  const auto k =
+      static_cast<int>(std::ceil(std::sqrt(static_cast<double>(nHoles))));
+  const auto cell = Radius / k;  // the grid spans a square of side Radius
+  const auto holeVerts = std::max(8, nVertices / 16);
+  for (int h = 0; h != nHoles; ++h) {
+    const auto x = (h % k + 0.5) * cell - Radius / 2;
+    const auto y = (h / k + 0.5) * cell - Radius / 2;
+    AppendCircle(poly.inners().emplace_back(), centre, x, y, 0.3 * cell,
+                 holeVerts, true, 0.0);
+  }
+  return poly;
+} // MakePart
+
+FarmDb MakeDb(int nFields, int nVertices, int nHoles) {
+  auto db = FarmDb{};
+  auto arena = tjg::ArenaScope{*db.arena};
+  auto& cust = *db.customers.emplace_back(
+                                     std::make_unique<Customer>("Bench"));
+  auto& farm = *db.farms.emplace_back(std::make_unique<Farm>("Bench"));
+  farm.customer = &cust;
+  cust.farms.push_back(&farm);
+  for (int f = 0; f != nFields; ++f) {
+    auto& field = *db.fields.emplace_back(
+        std::make_unique<Field>("Field " + std::to_string(f + 1)));
+    field.customer = &cust;
+    field.farm     = &farm;
+    farm.fields.push_back(&field);
+    // Fields sit 2 km apart so each gets its own projection.
+    const auto centre = LatLon{(42.0 + 0.018 * (f / 8)) * units::deg,
+                               (-93.0 + 0.025 * (f % 8)) * units::deg};
+    field.parts.push_back(MakePart(centre, nVertices, nHoles));
+  }
+  return db;
+} // MakeDb
+
+std::size_t CountPoints(const FarmDb& db) {
+  auto n = std::size_t{0};
+  for (const auto& field: db.fields) {
+    for (const auto& part: field->parts) {
+      n += part.outer().size();
+      for (const auto& inner: part.inners())
+        n += inner.size();
+    }
+    for (const auto& swath: field->swaths)
+      n += swath.path.size();
+  }
+  return n;
+} // CountPoints
+
+// ---- Timing ----
+
+class Bench {
+  int _reps;
+
+public:
+  explicit Bench(int reps) : _reps{reps} {
+    std::cout << "case,stage,reps,items,min_ms,median_ms,mean_ms\n";
+  }
+
+  /// Runs `fn` `reps` times and prints one row.  `items` is the amount of
+  /// work per run, e.g. points, so rows of different sizes can be compared.
+  template<class F>
+  void time(const std::string& caseName, const char* stage,
+            std::size_t items, F&& fn)
+  {
+    std::cerr << caseName << ": " << stage << '\n';
+    auto ms = std::vector<double>{};
+    ms.reserve(static_cast<std::size_t>(_reps));
+    for (int r = 0; r != _reps; ++r) {
+      const auto t0 = std::chrono::steady_clock::now();
+      fn();
+      const auto t1 = std::chrono::steady_clock::now();
+      ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    std::ranges::sort(ms);
+    const auto mean = std::accumulate(ms.begin(), ms.end(), 0.0) / _reps;
+    std::cout << caseName << ',' << stage << ',' << _reps << ',' << items
+              << ',' << ms.front() << ',' << ms[ms.size() / 2] << ',' << mean
+              << '\n';
+  } // time
+}; // Bench
+
+FarmDb ReadAny(const fs::path& path) {
+  const auto ext = path.extension();
+  if (ext == ".shp") return FarmDb::ReadShp(path);
+  if (ext == ".zip") return FarmDb::ReadZip(path);
+  if (ext == ".fdb") return FarmDb::ReadFdb(path);
+  return FarmDb::ReadXml(path);
+} // ReadAny
+
+/// Times every stage on `db`, whose fields are replaced by inset swaths.
+void RunCase(Bench& bench, const std::string& name, FarmDb& db,
+             const Options& opts)
+{
+  const auto offset = opts.insetM * mp_units::si::metre;
+  const auto tol    = DefaultSimplifyTol;
+  const auto nPts   = CountPoints(db);
+
+  // The planar stages run part by part, as BoundarySwaths does.
+  auto projs   = std::vector<std::unique_ptr<Projection>>(db.fields.size());
+  auto xyParts = std::vector<xy::Polygon>{};
+  auto owners  = std::vector<const Projection*>{};
+  bench.time(name, "project", nPts, [&] {
+    xyParts.clear();
+    owners.clear();
+    for (auto f = std::size_t{0}; f != db.fields.size(); ++f) {
+      const auto& parts = db.fields[f]->parts;
+      if (parts.empty())
+        continue;
+      projs[f] = std::make_unique<Projection>(std::span{parts});
+      for (const auto& part: parts) {
+        xyParts.push_back(projs[f]->forward(part));
+        owners.push_back(projs[f].get());
+      }
+    }
+  });
+
+  // The same parts through the tangent plane, for comparison.
+  {
+    auto tangentParts = std::vector<xy::Polygon>{};
+    bench.time(name, "project_tangent", nPts, [&] {
+      tangentParts.clear();
+      for (const auto& field: db.fields) {
+        const auto& parts = field->parts;
+        if (parts.empty())
+          continue;
+        const auto proj = Projection{std::span{parts}, PlaneKind::Tangent};
+        for (const auto& part: parts)
+          tangentParts.push_back(proj.forward(part));
+      }
+    });
+  }
+
+  bench.time(name, "validate", nPts, [&] {
+    for (const auto& part: xyParts)
+      stage::Validate(part);
+  });
+
+  auto insets = std::vector<xy::MultiPolygon>(xyParts.size());
+  bench.time(name, "inset", nPts, [&] {
+    for (auto i = std::size_t{0}; i != xyParts.size(); ++i)
+      insets[i] = stage::Inset(xyParts[i], offset);
+  });
+
+  // Sharp corners, for comparison; the round insets go on to simplify.
+  {
+    auto mitered = std::vector<xy::MultiPolygon>(xyParts.size());
+    bench.time(name, "inset_miter", nPts, [&] {
+      for (auto i = std::size_t{0}; i != xyParts.size(); ++i)
+        mitered[i] = stage::Inset(xyParts[i], offset, MiterJoin{});
+    });
+  }
+
+  auto simps = std::vector<xy::MultiPolygon>(insets.size());
+  bench.time(name, "simplify", nPts, [&] {
+    for (auto i = std::size_t{0}; i != insets.size(); ++i)
+      simps[i] = stage::Simplify(insets[i], tol);
+  });
+
+  auto geos = std::vector<geo::MultiPolygon>(simps.size());
+  bench.time(name, "inverse", nPts, [&] {
+    for (auto i = std::size_t{0}; i != simps.size(); ++i)
+      geos[i] = owners[i]->inverse(simps[i]);
+  });
+
+  bench.time(name, "field_inset", nPts, [&] {
+    for (auto& field: db.fields)
+      field->resetProjection();
+    db.inset("Bench", offset);
+  });
+
+  const auto outPts = CountPoints(db);
+  const auto base   = opts.workDir / name;
+  const auto xmlPath = fs::path{base}.concat(".xml");
+  const auto wktPath = fs::path{base}.concat(".wkt");
+  const auto zipPath = fs::path{base}.concat(".zip");
+  const auto fdbPath = fs::path{base}.concat(".fdb");
+
+  bench.time(name, "write_xml", outPts, [&] { db.writeXml(xmlPath); });
+  bench.time(name, "read_xml",  outPts, [&] { (void) ReadAny(xmlPath); });
+  bench.time(name, "write_wkt", outPts, [&] { db.writeWkt(wktPath); });
+  bench.time(name, "write_wkt_mt", outPts,
+             [&] { db.writeWkt(wktPath, {.threads = 0}); });
+  bench.time(name, "write_wkt_gz", outPts,
+             [&] { db.writeWkt(fs::path{wktPath}.concat(".gz")); });
+  bench.time(name, "write_zip", outPts, [&] { db.writeZip(zipPath); });
+  bench.time(name, "write_zip_mt", outPts,
+             [&] { db.writeZip(zipPath, {.threads = 0}); });
+  bench.time(name, "write_zip_fast", outPts, [&] {
+    using C = farm_db::ZipOptions::Compression;
+    db.writeZip(zipPath, {.compression = C::Fast, .threads = 0});
+  });
+  bench.time(name, "read_zip",  outPts, [&] { (void) ReadAny(zipPath); });
+  bench.time(name, "write_fdb", outPts, [&] { db.writeFdb(fdbPath); });
+  bench.time(name, "read_fdb",  outPts, [&] { (void) ReadAny(fdbPath); });
+} // RunCase
+
+} // local
+
+int main(int argc, const char* argv[]) {
+  try {
+    const auto opts = ParseArgs(argc, argv);
+    if (!opts)
+      return 1;
+
+    auto bench = Bench{opts->reps};
+
+    for (auto v: opts->vertices) {
+      for (auto h: opts->holes) {
+        const auto name = "synth_v" + std::to_string(v)
+                        + "_h" + std::to_string(h)
+                        + "_f" + std::to_string(opts->fields);
+        auto db = MakeDb(opts->fields, v, h);
+        RunCase(bench, name, db, *opts);
+      }
+    }
+
+    for (const auto& path: opts->fixtures) {
+      const auto name = path.filename().string();
+      auto db = ReadAny(path);
+      bench.time(name, "read_input", CountPoints(db),
+                 [&] { (void) ReadAny(path); });
+      RunCase(bench, name, db, *opts);
+    }
+    return 0;
+  }
+  catch (std::exception& x) {
+    std::cerr << "Exception: " << x.what() << '\n';
+  }
+  catch (...) {
+    std::cerr << "Unknown exception\n";
+  }
+
+  return 1;
+} // main
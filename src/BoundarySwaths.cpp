@@ -2,6 +2,8 @@
 /// @copyright 2025 Terry Golubiewski, all rights reserved.
 /// @author Terry Golubiewski
 #include "BoundarySwaths.hpp"
+#include "Stats.hpp"
+#include "Validity.hpp"
 
 #include <boost/geometry/geometries/box.hpp>
 
@@ -11,11 +13,14 @@
 #include <boost/geometry/algorithms/buffer.hpp>
 #include <boost/geometry/algorithms/envelope.hpp>
 #include <boost/geometry/algorithms/centroid.hpp>
+#include <boost/geometry/algorithms/expand.hpp>
+#include <boost/geometry/algorithms/num_points.hpp>
 
 #include <boost/geometry/strategies/buffer/cartesian.hpp>
 #include <boost/geometry/strategies/agnostic/buffer_distance_symmetric.hpp>
 #include <boost/geometry/strategies/cartesian/buffer_side_straight.hpp>
 #include <boost/geometry/strategies/cartesian/buffer_join_round.hpp>
+#include <boost/geometry/strategies/cartesian/buffer_join_miter.hpp>
 #include <boost/geometry/strategies/cartesian/buffer_end_round.hpp>
 #include <boost/geometry/strategies/cartesian/buffer_point_circle.hpp>
 
@@ -25,13 +30,19 @@
 namespace gsl = gsl_lite;
 
 #include <algorithm>
+#include <array>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <vector>
 #include <stdexcept>
 #include <iterator>
 #include <type_traits>
+#include <variant>
 #include <limits>
 #include <cmath>
+#include <numbers>
 #include <cstdlib>
 
 namespace farm_db {
@@ -41,7 +52,9 @@ using PolyCorners = std::vector<CornerVec>;
 
 namespace Tune {
 
-constexpr int CirclePoints = 32;
+// Ends and points do not arise when insetting polygons; joins come from
+// the InsetJoin, whose default this matches.
+constexpr int CirclePoints = RoundJoin{}.points;
 
 // Douglas–Peucker for corner detection
 constexpr auto SimplifyForCorners = 10.0 * mp_units::si::metre;
@@ -49,47 +62,103 @@ constexpr auto CornerAngle        = 45.0 * mp_units::si::degree;
 
 } // Tune
 
+std::array<double, 4> InsetTuning() noexcept {
+  static constexpr auto Revision = 1.0;
+  return {Revision, double{Tune::CirclePoints},
+          Tune::SimplifyForCorners.numerical_value_in(mp_units::si::metre),
+          Tune::CornerAngle.numerical_value_in(mp_units::si::degree)};
+} // InsetTuning
+
 namespace detail {
 
 template<class Geo>
 requires (!std::is_same_v<Geo, xy::Ring>)
 void EnsureValid(const Geo& geo) {
+  auto timer = StageTimer{Stats::Validate};
   auto failure = ggl::validity_failure_type{};
-  if (ggl::is_valid(geo, failure)) [[likely]]
+  if (IsValid(geo, failure)) [[likely]]
     return;
   auto msg = std::string{"Invalid geometry: "};
   msg += ggl::validity_failure_type_message(failure);
   throw std::runtime_error{msg};
 } // EnsureValid
 
-xy::MultiPolygon ComputeInset(const xy::Polygon& in, Distance offset) {
+inline auto JoinStrategy(const RoundJoin& j) {
+  const auto points = static_cast<std::size_t>(j.points);
+  return ggl::strategy::buffer::join_round{points};
+} // JoinStrategy
+
+inline auto JoinStrategy(const MiterJoin& j)
+  { return ggl::strategy::buffer::join_miter{j.limit}; }
+
+void CheckJoin(const InsetJoin& join) {
+  if (auto round = std::get_if<RoundJoin>(&join); round && round->points < 4)
+    throw std::runtime_error{"round join needs at least 4 points"};
+  if (auto miter = std::get_if<MiterJoin>(&join); miter && miter->limit < 1.0)
+    throw std::runtime_error{"miter limit must be >= 1"};
+} // CheckJoin
+
+// `in` must already be valid; the result, written over `inset`, is checked.
+// Also applied to a previous inset to step on to the next distance, since
+// insetting by a and then by b is the same as insetting by a+b.  `Join` is a
+// ggl buffer join strategy, fixed at compile time.
+template<class Geo, class Join>
+void ComputeInset(const Geo& in, xy::MultiPolygon& inset, Distance offset,
+                  const Join& join)
+{
   static constexpr auto metre =  mp_units::si::metre;
-  EnsureValid(in);
-  gsl_Expects(offset >= 1.0 * metre);
+  gsl_Expects(offset > 0.0 * metre);
 
   // ---- Inset buffer (negative distance) ----
   auto distance = ggl::strategy::buffer::distance_symmetric<double>
                                             {-offset.numerical_value_in(metre)};
   auto side  = ggl::strategy::buffer::side_straight{};
-  auto join  = ggl::strategy::buffer::join_round{Tune::CirclePoints};
   auto end   = ggl::strategy::buffer::end_round{Tune::CirclePoints};
   auto point = ggl::strategy::buffer::point_circle{Tune::CirclePoints};
 
-  auto inset = xy::MultiPolygon{};
-  ggl::buffer(in, inset, distance, side, join, end, point);
+  {
+    auto timer = StageTimer{Stats::Buffer};
+    ggl::buffer(in, inset, distance, side, join, end, point);
+  }
   EnsureValid(inset);
+} // ComputeInset
+
+template<class Geo>
+void ComputeInset(const Geo& in, xy::MultiPolygon& inset, Distance offset,
+                  const InsetJoin& join)
+{
+  std::visit([&](const auto& j)
+               { ComputeInset(in, inset, offset, JoinStrategy(j)); },
+             join);
+} // ComputeInset
+
+template<class Geo>
+xy::MultiPolygon ComputeInset(const Geo& in, Distance offset,
+                              const InsetJoin& join)
+{
+  auto inset = xy::MultiPolygon{};
+  ComputeInset(in, inset, offset, join);
   return inset;
 } // ComputeInset
 
+// Halves the tolerance until `geo` simplifies to something valid; returns
+// `geo` itself if nothing down to 1 cm works.  Passes after the first, or
+// every pass when `retrying`, count as SimplifyRetry time.
 template<class Geo>
-Geo Simplify(const Geo& geo, Distance tolerance) {
+Geo SimplifyHalving(const Geo& geo, Distance tolerance, bool retrying = false)
+{
   static constexpr auto metre = mp_units::si::metre;
-  gsl_Expects(tolerance >= 0.01 * metre);
+  auto stats = Stats::Current();
+  auto retry = std::optional<StageTimer>{};
+  if (retrying)
+    retry.emplace(Stats::SimplifyRetry);
   auto simp = Geo{};
   auto failure = ggl::validity_failure_type{};
   while (tolerance >= 0.01 * metre) {
+    if (stats)
+      ++stats->simplifyCalls;
     ggl::simplify(geo, simp, tolerance.numerical_value_in(metre));
-    if (ggl::is_valid(simp, failure)
+    if (IsValid(simp, failure)
         || failure == ggl::failure_wrong_orientation)
       return simp;
     switch (failure) {
@@ -104,11 +173,66 @@ Geo Simplify(const Geo& geo, Distance tolerance) {
     }
     tolerance /= 2;
     simp.clear();
+    if (stats)
+      ++stats->simplifyHalvings;
+    if (!retry)
+      retry.emplace(Stats::SimplifyRetry);
   }
   return geo;
+} // SimplifyHalving
+
+// Each ring backs off on its own, so one tight corner costs only its ring
+// another pass.  Checking a ring alone is also much cheaper than checking
+// the whole multipolygon.
+xy::Polygon SimplifyRings(const xy::Polygon& poly, Distance tolerance) {
+  auto out = xy::Polygon{};
+  out.outer() = SimplifyHalving(poly.outer(), tolerance);
+  out.inners().reserve(poly.inners().size());
+  for (const auto& inner: poly.inners())
+    out.inners().push_back(SimplifyHalving(inner, tolerance));
+  return out;
+} // SimplifyRings
+
+xy::MultiPolygon SimplifyRings(const xy::MultiPolygon& mp, Distance tolerance)
+{
+  auto out = xy::MultiPolygon{};
+  out.reserve(mp.size());
+  for (const auto& poly: mp)
+    out.push_back(SimplifyRings(poly, tolerance));
+  return out;
+} // SimplifyRings
+
+// Douglas-Peucker moves no edge farther than the tolerance, so rings that
+// are valid alone rarely cross one another; one check of the whole result
+// confirms it.  Only when they do is the whole geometry simplified again,
+// as before, from half the tolerance.
+template<class Geo>
+Geo Simplify(const Geo& geo, Distance tolerance) {
+  static constexpr auto metre = mp_units::si::metre;
+  gsl_Expects(tolerance >= 0.01 * metre);
+  auto timer = StageTimer{Stats::Simplify};
+  if constexpr (std::is_same_v<Geo, xy::Ring>) {
+    return SimplifyHalving(geo, tolerance);
+  } else {
+    auto simp = SimplifyRings(geo, tolerance);
+    auto failure = ggl::validity_failure_type{};
+    if (IsValid(simp, failure)
+        || failure == ggl::failure_wrong_orientation)
+      return simp;
+    if (auto stats = Stats::Current())
+      ++stats->simplifyHalvings;
+    return SimplifyHalving(geo, tolerance / 2, true);
+  }
 } // Simplify
 
-// Map simplified-corner points to indices in the ORIGINAL ring (ordered match)
+// Map simplified-corner points to indices in the ORIGINAL ring.
+// Douglas-Peucker keeps a subsequence of the original vertices, but
+// ggl::simplify rotates a closed ring to start elsewhere, so the corners
+// come in the original's cyclic order from an unknown start.  Each corner
+// is found by walking on, cyclically, from the previous one (the first
+// from index 0) and stopping at the exact match, so the ring is walked
+// about once in all rather than once per corner.  A corner with no exact
+// match falls back to the nearest vertex on the whole ring.
 CornerVec MapCornersToOriginal(const xy::Ring& orig, const xy::Ring& simp,
                                const CornerVec& simp_corners)
 {
@@ -116,21 +240,22 @@ CornerVec MapCornersToOriginal(const xy::Ring& orig, const xy::Ring& simp,
   out.reserve(simp_corners.size());
   if (orig.empty() || simp.empty() || simp_corners.empty()) return out;
 
+  // The closing point repeats orig[0].
+  const auto n = std::max(std::ssize(orig) - 1, gsl::index{1});
+  constexpr auto zero = geom::DistanceSq::zero();
   auto i0 = gsl::index{0};
 
   for (auto simp_idx: simp_corners) {
     const xy::Point& corner = simp[simp_idx];
     auto best_i  = i0;
     auto best_d2 = Dist2(orig[i0], corner);
-
-    // scan forward around the ring once
-    const auto n = std::ssize(orig) - 1;
-    for (auto i = gsl::index{i0+1}; i != n; ++i) {
+    for (auto k = gsl::index{1}; best_d2 != zero && k < n; ++k) {
+      const auto i = (i0 + k) % n;
       const auto d2 = Dist2(orig[i], corner);
       if (d2 < best_d2) { best_d2 = d2; best_i = i; }
     }
     out.push_back(best_i);
-    i0 = std::min(gsl::index{0}, best_i + 1);
+    i0 = best_i;
   }
 
   std::sort(out.begin(), out.end());
@@ -261,15 +386,6 @@ template<> struct Xy<geo::MultiPath>    { using type = xy::MultiPath;    };
 template<> struct Xy<geo::Polygon>      { using type = xy::Polygon;      };
 template<> struct Xy<geo::MultiPolygon> { using type = xy::MultiPolygon; };
 
-template<class G, class Proj, typename CT>
-XyT<G> TransformToXy(const G& geo_in,
-                   const typename ggl::projections::projection<Proj, CT>& proj)
-{
-  auto geo_out = XyT<G>{};
-  proj.forward(geo_in, geo_out);
-  return geo_out;
-} // TransformToXy
-
 template<class X, class Proj, typename CT>
 GeoT<X> TransformToGeo(const X& geo_in,
                        const ggl::projections::projection<Proj, CT>& proj)
@@ -291,15 +407,125 @@ TransformToGeo(const std::vector<xy::MultiPath>& in,
   return out;
 } // TransformToGeo(vector<xy::MultiPath>)
 
-template<class Geo>
-auto MakeProjection(const Geo& geo) {
+// The rings of `poly`, outer first, each split at its corners.
+std::vector<xy::MultiPath> SplitAtCorners(xy::Polygon poly) {
+  auto corners = FindCorners(poly); // rotates each ring to start at a corner
+  gsl_Expects(std::ssize(corners) == 1 + std::ssize(poly.inners()));
+  auto out = std::vector<xy::MultiPath>{};
+  out.reserve(corners.size());
+  auto cp = std::cbegin(corners);
+  out.push_back(ExtractSwaths(poly.outer(), *cp));
+  for (const auto& ring: poly.inners())
+    out.push_back(ExtractSwaths(ring, *++cp));
+  return out;
+} // SplitAtCorners
+
+// Builds `out` with the structure of `in`, passing each contiguous run of
+// points (a ring or a linestring) to `fn(in, out, n)` in one call.
+template<class In, class Out, class Fn>
+void MapPoints(const In& in, Out& out, const Fn& fn) {
+  using Tag = typename ggl::tag<In>::type;
+  if constexpr (std::is_same_v<Tag, ggl::polygon_tag>) {
+    MapPoints(in.outer(), out.outer(), fn);
+    out.inners().resize(in.inners().size());
+    for (auto i = std::size_t{0}; i != in.inners().size(); ++i)
+      MapPoints(in.inners()[i], out.inners()[i], fn);
+  } else if constexpr (std::is_same_v<Tag, ggl::multi_polygon_tag>
+                    || std::is_same_v<Tag, ggl::multi_linestring_tag>) {
+    out.resize(in.size());
+    for (auto i = std::size_t{0}; i != in.size(); ++i)
+      MapPoints(in[i], out[i], fn);
+  } else {
+    out.resize(in.size());
+    fn(in.data(), out.data(), in.size());
+  }
+} // MapPoints
+
+// Orthographic projection onto the plane tangent to the WGS84 ellipsoid at
+// the origin: geodetic to earth-centred coordinates, then east and north
+// components of the offset from the origin.  Lengths within d of the origin
+// are shortened by at most (d/R)^2/2, 1.3e-6 at 10 km, and the inverse
+// drops each point back along the plane's normal onto the ellipsoid, so a
+// round trip is exact to rounding.  Each loop body is straight-line
+// arithmetic with no calls into proj.
+class TangentPlane {
+  static constexpr double A  = 6378137.0;           // semi-major axis, m
+  static constexpr double F  = 1 / 298.257223563;   // flattening
+  static constexpr double E2 = F * (2 - F);         // eccentricity squared
+  static constexpr double B2 = A * A * (1 - E2);    // semi-minor squared
+  static constexpr double Rad = std::numbers::pi / 180;
+
+  struct Vec3 { double x, y, z; };
+  Vec3 _o;  // origin
+  Vec3 _e;  // unit east
+  Vec3 _n;  // unit north
+  Vec3 _u;  // unit up, the ellipsoid normal at the origin
+  double _qa; // quadratic coefficient of the inverse, constant per plane
+
+  static Vec3 Ecef(double lat, double lon) noexcept {
+    const auto sLat = std::sin(lat), cLat = std::cos(lat);
+    const auto nu = A / std::sqrt(1 - E2 * sLat * sLat);
+    return {nu * cLat * std::cos(lon), nu * cLat * std::sin(lon),
+            nu * (1 - E2) * sLat};
+  } // Ecef
+
+public:
+  explicit TangentPlane(const geo::Point& origin) noexcept {
+    const auto lat = ggl::get<1>(origin) * Rad;
+    const auto lon = ggl::get<0>(origin) * Rad;
+    const auto sLat = std::sin(lat), cLat = std::cos(lat);
+    const auto sLon = std::sin(lon), cLon = std::cos(lon);
+    _o = Ecef(lat, lon);
+    _e = {-sLon, cLon, 0};
+    _n = {-sLat * cLon, -sLat * sLon, cLat};
+    _u = { cLat * cLon,  cLat * sLon, sLat};
+    _qa = (_u.x * _u.x + _u.y * _u.y) / (A * A) + _u.z * _u.z / B2;
+  } // ctor
+
+  void forward(const geo::Point* in, xy::Point* out, std::size_t n) const
+  {
+    for (auto i = std::size_t{0}; i != n; ++i) {
+      const auto p = Ecef(ggl::get<1>(in[i]) * Rad,
+                          ggl::get<0>(in[i]) * Rad);
+      const auto dx = p.x - _o.x, dy = p.y - _o.y, dz = p.z - _o.z;
+      ggl::set<0>(out[i], _e.x * dx + _e.y * dy);
+      ggl::set<1>(out[i], _n.x * dx + _n.y * dy + _n.z * dz);
+    }
+  } // forward
+
+  void inverse(const xy::Point* in, geo::Point* out, std::size_t n) const
+  {
+    for (auto i = std::size_t{0}; i != n; ++i) {
+      const auto e = ggl::get<0>(in[i]);
+      const auto nn = ggl::get<1>(in[i]);
+      const auto qx = _o.x + e * _e.x + nn * _n.x;
+      const auto qy = _o.y + e * _e.y + nn * _n.y;
+      const auto qz = _o.z + e * _e.z + nn * _n.z;
+      // q + t*u on the ellipsoid: the small root of a quadratic in t,
+      // written to avoid cancellation.
+      const auto qb = 2 * ((qx * _u.x + qy * _u.y) / (A * A)
+                           + qz * _u.z / B2);
+      const auto qc = (qx * qx + qy * qy) / (A * A) + qz * qz / B2 - 1;
+      const auto t  = -2 * qc / (qb + std::sqrt(qb * qb - 4 * _qa * qc));
+      const auto x = qx + t * _u.x, y = qy + t * _u.y, z = qz + t * _u.z;
+      // On the surface the latitude is exact in closed form.
+      const auto lat = std::atan2(z, (1 - E2) * std::hypot(x, y));
+      ggl::set<0>(out[i], std::atan2(y, x) / Rad);
+      ggl::set<1>(out[i], lat / Rad);
+    }
+  } // inverse
+}; // TangentPlane
+
+using GeoBox = ggl::model::box<geo::Point>;
+
+geo::Point Origin(const GeoBox& env)
+  { return ggl::return_centroid<geo::Point>(env); }
+
+auto MakeProjection(const geo::Point& origin) {
   using namespace ggl;
   using namespace ggl::srs;
   using namespace ggl::srs::dpar;
 
-  using GeoBox = ggl::model::box<geo::Point>;
-  auto env = ggl::return_envelope<GeoBox>(geo);
-  auto origin = ggl::return_centroid<geo::Point>(env);
   const auto origin_lat = ggl::get<1>(origin);
   const auto origin_lon = ggl::get<0>(origin);
   projection<> proj = parameters<>(proj_aeqd)
@@ -311,35 +537,273 @@ auto MakeProjection(const Geo& geo) {
 } // detail
 
 xy::MultiPolygon
-BoundarySwaths(const xy::Polygon& poly_in, Distance offset, Distance simplifyTol) {
+BoundarySwaths(const xy::Polygon& poly_in, Distance offset, Distance simplifyTol,
+               const InsetJoin& join)
+{
   if (offset < 0.10 * mp_units::si::metre)
     throw std::runtime_error{"<offset_m> must be >= 10 cm"};
-  // (void) FindCorners(poly_in); // Modifys poly_in.
-  auto inset_mp = detail::ComputeInset(poly_in, offset);
+  detail::CheckJoin(join);
+  detail::EnsureValid(poly_in);
+  auto inset_mp = detail::ComputeInset(poly_in, offset, join);
   auto simp_mp  = detail::Simplify(inset_mp, simplifyTol);
+  if (auto stats = Stats::Current()) {
+    stats->verticesIn  += ggl::num_points(poly_in);
+    stats->verticesOut += ggl::num_points(simp_mp);
+  }
   return simp_mp;
-#if 0
-  auto linesVec = std::vector<xy::MultiPath>{};
-  for (auto& poly: simp_mp) {
-    auto cv = detail::FindCorners(poly); // Modifies poly
-    gsl_Expects(std::ssize(cv) == 1 + std::ssize(poly.inners()));
-    auto cp = std::begin(cv);
-    linesVec.emplace_back(detail::ExtractSwaths(poly.outer(), *cp));
-    for (const auto& ring: poly.inners())
-      linesVec.emplace_back(detail::ExtractSwaths(ring, *++cp));
+} // BoundarySwaths
+
+namespace detail {
+
+void CheckOffsets(std::span<const Distance> offsets) {
+  if (offsets.front() < 0.10 * mp_units::si::metre)
+    throw std::runtime_error{"<offset_m> must be >= 10 cm"};
+  for (auto i = std::size_t{1}; i != offsets.size(); ++i) {
+    if (offsets[i] <= offsets[i-1])
+      throw std::runtime_error{"inset distances must be increasing"};
+  }
+} // CheckOffsets
+
+// Every pass of an already validated polygon; `offsets` must be checked.
+std::vector<xy::MultiPolygon>
+InsetPasses(const xy::Polygon& valid, std::span<const Distance> offsets,
+            Distance simplifyTol, const InsetJoin& join)
+{
+  // The unsimplified passes are only stepping stones; they alternate
+  // between two buffers that each thread keeps from one part to the next.
+  thread_local auto inset_mp = xy::MultiPolygon{};
+  thread_local auto next_mp  = xy::MultiPolygon{};
+  auto out = std::vector<xy::MultiPolygon>{};
+  out.reserve(offsets.size());
+  ComputeInset(valid, inset_mp, offsets.front(), join);
+  out.push_back(Simplify(inset_mp, simplifyTol));
+  for (auto i = std::size_t{1}; i != offsets.size(); ++i) {
+    // Each pass grows from the previous unsimplified inset, so tolerance
+    // does not accumulate and the buffer has less to chew through.
+    if (!inset_mp.empty()) {
+      ComputeInset(inset_mp, next_mp, offsets[i] - offsets[i-1], join);
+      inset_mp.swap(next_mp);
+    }
+    out.push_back(Simplify(inset_mp, simplifyTol));
+  }
+  if (auto stats = Stats::Current()) {
+    stats->verticesIn += ggl::num_points(valid);
+    for (const auto& mp: out)
+      stats->verticesOut += ggl::num_points(mp);
   }
-  return linesVec;
-#endif
+  return out;
+} // InsetPasses
+
+} // detail
+
+std::vector<xy::MultiPolygon>
+BoundarySwaths(const xy::Polygon& poly_in, std::span<const Distance> offsets,
+               Distance simplifyTol, const InsetJoin& join)
+{
+  if (offsets.empty())
+    return {};
+  detail::CheckOffsets(offsets);
+  detail::CheckJoin(join);
+  detail::EnsureValid(poly_in);
+  return detail::InsetPasses(poly_in, offsets, simplifyTol, join);
 } // BoundarySwaths
 
+namespace stage {
+
+void Validate(const xy::Polygon& poly) { detail::EnsureValid(poly); }
+
+xy::MultiPolygon Inset(const xy::Polygon& valid, Distance offset,
+                       const InsetJoin& join)
+  { return detail::ComputeInset(valid, offset, join); }
+
+xy::MultiPolygon Simplify(const xy::MultiPolygon& in, Distance tolerance)
+  { return detail::Simplify(in, tolerance); }
+
+} // stage
+
+struct Projection::Impl {
+  geo::Point origin;
+  PlaneKind kind;
+  std::optional<ggl::srs::projection<>> proj;   // PlaneKind::Aeqd
+  std::optional<detail::TangentPlane>   plane;  // PlaneKind::Tangent
+
+  Impl(const geo::Point& origin_, PlaneKind kind_)
+    : origin{origin_}, kind{kind_}
+  {
+    if (kind == PlaneKind::Tangent)
+      plane.emplace(origin);
+    else
+      proj.emplace(detail::MakeProjection(origin));
+  } // ctor
+
+  // Both paths resize `out` to fit rather than rebuild it.
+  template<class Out, class In>
+  void forward(const In& in, Out& out) const {
+    if (!plane) {
+      proj->forward(in, out);
+      return;
+    }
+    detail::MapPoints(in, out, [this](auto* p, auto* q, std::size_t n)
+                                 { plane->forward(p, q, n); });
+  } // forward
+
+  template<class Out, class In>
+  Out inverse(const In& in) const {
+    if (!plane)
+      return detail::TransformToGeo(in, *proj);
+    auto out = Out{};
+    detail::MapPoints(in, out, [this](auto* p, auto* q, std::size_t n)
+                                 { plane->inverse(p, q, n); });
+    return out;
+  } // inverse
+}; // Impl
+
+Projection::Projection(const geo::Polygon& poly, PlaneKind kind) {
+  auto timer = StageTimer{Stats::Project};
+  _impl = std::make_shared<const Impl>(detail::Origin(
+                  ggl::return_envelope<detail::GeoBox>(poly)), kind);
+} // ctor
+
+Projection::Projection(std::span<const geo::Polygon> parts, PlaneKind kind)
+{
+  gsl_Expects(!parts.empty());
+  auto timer = StageTimer{Stats::Project};
+  auto env = ggl::return_envelope<detail::GeoBox>(parts.front());
+  for (const auto& part: parts.subspan(1))
+    ggl::expand(env, ggl::return_envelope<detail::GeoBox>(part));
+  _impl = std::make_shared<const Impl>(detail::Origin(env), kind);
+} // ctor
+
+const geo::Point& Projection::origin() const noexcept
+  { return _impl->origin; }
+
+PlaneKind Projection::kind() const noexcept { return _impl->kind; }
+
+xy::Polygon Projection::forward(const geo::Polygon& in) const {
+  auto out = xy::Polygon{};
+  forward(in, out);
+  return out;
+} // forward
+
+void Projection::forward(const geo::Polygon& in, xy::Polygon& out) const {
+  auto timer = StageTimer{Stats::Project};
+  _impl->forward(in, out);
+} // forward
+
+geo::MultiPolygon Projection::inverse(const xy::MultiPolygon& in) const {
+  auto timer = StageTimer{Stats::Inverse};
+  return _impl->inverse<geo::MultiPolygon>(in);
+} // inverse
+
+geo::MultiPath Projection::inverse(const xy::MultiPath& in) const {
+  auto timer = StageTimer{Stats::Inverse};
+  return _impl->inverse<geo::MultiPath>(in);
+} // inverse
+
 geo::MultiPolygon
-BoundarySwaths(const geo::Polygon& poly_in, Distance offset, Distance simplifyTol)
+BoundarySwaths(const geo::Polygon& poly_in, const Projection& proj,
+               Distance offset, Distance simplifyTol, const InsetJoin& join)
 {
-  const auto proj = detail::MakeProjection(poly_in);
-  auto xyPoly  = detail::TransformToXy(poly_in, proj);
-  auto xyOut   = BoundarySwaths(xyPoly, offset, simplifyTol);
-  auto geoPoly = detail::TransformToGeo(xyOut, proj);
+  auto xyPoly  = proj.forward(poly_in);
+  auto xyOut   = BoundarySwaths(xyPoly, offset, simplifyTol, join);
+  auto geoPoly = proj.inverse(xyOut);
   return geoPoly;
 } // BoundarySwaths
 
+namespace detail {
+
+std::vector<geo::MultiPolygon>
+ToGeo(const Projection& proj, const std::vector<xy::MultiPolygon>& xyOut) {
+  auto out = std::vector<geo::MultiPolygon>{};
+  out.reserve(xyOut.size());
+  for (const auto& mp: xyOut)
+    out.push_back(proj.inverse(mp));
+  return out;
+} // ToGeo
+
+// Consumes `xyOut`: each polygon is rotated to its corners in place.
+std::vector<InsetEdges>
+ToEdges(const Projection& proj, std::vector<xy::MultiPolygon>&& xyOut) {
+  auto out = std::vector<InsetEdges>{};
+  out.reserve(xyOut.size());
+  for (auto& mp: xyOut) {
+    auto& edges = out.emplace_back();
+    edges.reserve(mp.size());
+    for (auto& poly: mp) {
+      auto& polyEdges = edges.emplace_back();
+      polyEdges.reserve(1 + poly.inners().size());
+      for (const auto& ring: SplitAtCorners(std::move(poly)))
+        polyEdges.push_back(proj.inverse(ring));
+    }
+  }
+  return out;
+} // ToEdges
+
+// `poly` on the plane of `proj`, in a buffer each thread reuses from one
+// part to the next.  Valid until the thread's next call.
+const xy::Polygon& Planar(const geo::Polygon& poly, const Projection& proj) {
+  thread_local auto scratch = xy::Polygon{};
+  proj.forward(poly, scratch);
+  return scratch;
+} // Planar
+
+std::vector<xy::MultiPolygon>
+ValidPasses(const xy::Polygon& valid, std::span<const Distance> offsets,
+            Distance simplifyTol, const InsetJoin& join)
+{
+  if (offsets.empty())
+    return {};
+  CheckOffsets(offsets);
+  CheckJoin(join);
+  return InsetPasses(valid, offsets, simplifyTol, join);
+} // ValidPasses
+
+} // detail
+
+std::vector<geo::MultiPolygon>
+BoundarySwaths(const geo::Polygon& poly_in, const Projection& proj,
+               std::span<const Distance> offsets, Distance simplifyTol,
+               const InsetJoin& join)
+{
+  const auto& xyPoly = detail::Planar(poly_in, proj);
+  return detail::ToGeo(proj,
+                       BoundarySwaths(xyPoly, offsets, simplifyTol, join));
+} // BoundarySwaths
+
+std::vector<InsetEdges>
+BoundaryEdges(const geo::Polygon& poly_in, const Projection& proj,
+              std::span<const Distance> offsets, Distance simplifyTol,
+              const InsetJoin& join)
+{
+  const auto& xyPoly = detail::Planar(poly_in, proj);
+  return detail::ToEdges(proj,
+                         BoundarySwaths(xyPoly, offsets, simplifyTol, join));
+} // BoundaryEdges
+
+std::vector<geo::MultiPolygon>
+ValidBoundarySwaths(const xy::Polygon& valid, const Projection& proj,
+                    std::span<const Distance> offsets, Distance simplifyTol,
+                    const InsetJoin& join)
+{
+  return detail::ToGeo(proj,
+      detail::ValidPasses(valid, offsets, simplifyTol, join));
+} // ValidBoundarySwaths
+
+std::vector<InsetEdges>
+ValidBoundaryEdges(const xy::Polygon& valid, const Projection& proj,
+                   std::span<const Distance> offsets, Distance simplifyTol,
+                   const InsetJoin& join)
+{
+  return detail::ToEdges(proj,
+      detail::ValidPasses(valid, offsets, simplifyTol, join));
+} // ValidBoundaryEdges
+
+geo::MultiPolygon
+BoundarySwaths(const geo::Polygon& poly_in, Distance offset, Distance simplifyTol,
+               const InsetJoin& join)
+{
+  return BoundarySwaths(poly_in, Projection{poly_in}, offset, simplifyTol,
+                        join);
+} // BoundarySwaths
+
 } // farm_db
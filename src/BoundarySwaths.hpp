@@ -6,6 +6,11 @@
 #include "FarmGeo.hpp"
 #include "FarmXy.hpp"
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 
 namespace farm_db {
@@ -14,12 +19,117 @@ using Distance = geom::Distance;
 
 constexpr Distance DefaultSimplifyTol = 0.10 * mp_units::si::metre;
 
+/// The constants that shape every inset, led by a revision that changes
+/// whenever the algorithm's output does; cached insets are keyed on them.
+std::array<double, 4> InsetTuning() noexcept;
+
+/// `join` picks the buffer strategy for corners; each alternative is a
+/// separately compiled ComputeInset, so neither pays for the other.
 xy::MultiPolygon
 BoundarySwaths(const xy::Polygon& poly_in, Distance offset,
-               Distance simplifyTol = DefaultSimplifyTol);
+               Distance simplifyTol = DefaultSimplifyTol,
+               const InsetJoin& join = RoundJoin{});
+
+/// One inset per entry of `offsets`, which must be strictly increasing.
+/// The polygon is validated once and each pass is buffered from the one
+/// before it rather than from `poly_in`.
+std::vector<xy::MultiPolygon>
+BoundarySwaths(const xy::Polygon& poly_in, std::span<const Distance> offsets,
+               Distance simplifyTol = DefaultSimplifyTol,
+               const InsetJoin& join = RoundJoin{});
+
+/// The stages of the planar BoundarySwaths, one at a time, so benchmarks
+/// can time them separately.
+namespace stage {
+
+void             Validate(const xy::Polygon& poly);
+xy::MultiPolygon Inset(const xy::Polygon& valid, Distance offset,
+                       const InsetJoin& join = RoundJoin{});
+xy::MultiPolygon Simplify(const xy::MultiPolygon& in, Distance tolerance);
+
+} // stage
+
+/// Plane centred on an area of interest, used to run the planar inset on
+/// geographic input: azimuthal-equidistant through proj, or with
+/// PlaneKind::Tangent the local tangent plane, computed directly over each
+/// ring's points.  Building an Aeqd one parses the proj parameters, so keep
+/// it for every polygon in the area and every inset distance.  Copies share
+/// the projection; it is safe to use from several threads at once.
+class Projection {
+  struct Impl;
+  std::shared_ptr<const Impl> _impl;
+
+public:
+  /// Centred on the envelope of `poly`.
+  explicit Projection(const geo::Polygon& poly,
+                      PlaneKind kind = PlaneKind::Aeqd);
+
+  /// Centred on the envelope of all `parts`, which must not be empty.
+  explicit Projection(std::span<const geo::Polygon> parts,
+                      PlaneKind kind = PlaneKind::Aeqd);
+
+  const geo::Point& origin() const noexcept;
+  PlaneKind kind() const noexcept;
+
+  xy::Polygon       forward(const geo::Polygon& in)      const;
+  /// Into `out`, reusing the storage it already has.
+  void              forward(const geo::Polygon& in, xy::Polygon& out) const;
+  geo::MultiPolygon inverse(const xy::MultiPolygon& in) const;
+  geo::MultiPath    inverse(const xy::MultiPath& in)    const;
+}; // Projection
+
+geo::MultiPolygon
+BoundarySwaths(const geo::Polygon& poly_in, const Projection& proj,
+               Distance offset, Distance simplifyTol = DefaultSimplifyTol,
+               const InsetJoin& join = RoundJoin{});
+
+std::vector<geo::MultiPolygon>
+BoundarySwaths(const geo::Polygon& poly_in, const Projection& proj,
+               std::span<const Distance> offsets,
+               Distance simplifyTol = DefaultSimplifyTol,
+               const InsetJoin& join = RoundJoin{});
+
+/// One inset polygon split at its corners (turns of 45 degrees or more,
+/// found on a 10 m simplification) into open edges: one MultiPath for the
+/// outer ring, then one per inner ring.
+using PolyEdges  = std::vector<geo::MultiPath>;
+using InsetEdges = std::vector<PolyEdges>; // one per inset polygon
+
+/// As BoundarySwaths, with each inset ring split into its edges.
+std::vector<InsetEdges>
+BoundaryEdges(const geo::Polygon& poly_in, const Projection& proj,
+              std::span<const Distance> offsets,
+              Distance simplifyTol = DefaultSimplifyTol,
+              const InsetJoin& join = RoundJoin{});
+
+/// As the two above for `valid`: a part already projected with `proj` and
+/// passed through stage::Validate.  A part inset again and again is then
+/// projected and validated only once.
+std::vector<geo::MultiPolygon>
+ValidBoundarySwaths(const xy::Polygon& valid, const Projection& proj,
+                    std::span<const Distance> offsets,
+                    Distance simplifyTol = DefaultSimplifyTol,
+                    const InsetJoin& join = RoundJoin{});
+
+std::vector<InsetEdges>
+ValidBoundaryEdges(const xy::Polygon& valid, const Projection& proj,
+                   std::span<const Distance> offsets,
+                   Distance simplifyTol = DefaultSimplifyTol,
+                   const InsetJoin& join = RoundJoin{});
+
+/// Part `p` of a Field projected and validated once; see Field::planarPart.
+/// `valid[p]` records that part `p` has passed stage::Validate on this
+/// plane, kept or not, so that later insets need not check it again.
+struct PlanarParts {
+  std::vector<std::optional<xy::Polygon>> parts;
+  std::vector<std::uint8_t> valid;
+}; // PlanarParts
 
+/// As the geo BoundarySwaths above, with a projection centred on `poly_in`
+/// alone.
 geo::MultiPolygon
 BoundarySwaths(const geo::Polygon& poly_in, Distance offset,
-               Distance simplifyTol = DefaultSimplifyTol);
+               Distance simplifyTol = DefaultSimplifyTol,
+               const InsetJoin& join = RoundJoin{});
 
 } // farm_db
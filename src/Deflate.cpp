@@ -0,0 +1,159 @@
+/// @file
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+#include "Deflate.hpp"
+#include "parallel.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstring>
+
+namespace tjg {
+
+namespace {
+
+// Big enough that compressing, not scheduling, dominates; small enough
+// that a round stays a few MiB per thread.
+constexpr std::size_t BlockSize       = 1024 * 1024;
+constexpr std::size_t DictSize        = 32 * 1024;
+constexpr std::size_t BlocksPerThread = 2;
+
+[[noreturn]] void ThrowDeflateError(const char* msg) {
+  throw std::runtime_error{std::string{"ParallelDeflate: "} + msg};
+} // ThrowDeflateError
+
+std::string_view Tail(std::string_view s) noexcept
+  { return s.substr(s.size() - std::min(s.size(), DictSize)); }
+
+// Reads until `size` bytes or the end of the data.
+std::size_t Fill(const DeflateReadFn& read, char* buf, std::size_t size) {
+  auto n = std::size_t{0};
+  while (n != size) {
+    const auto got = read(buf + n, size - n);
+    if (got == 0)
+      break;
+    n += got;
+  }
+  return n;
+} // Fill
+
+template<class Block>
+void Compress(Block& b, std::string_view dict, int level) {
+  auto zs = z_stream{};
+  if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    ThrowDeflateError("cannot initialize zlib");
+  }
+  struct End {
+    z_stream& zs;
+    ~End() noexcept { (void) deflateEnd(&zs); }
+  } end{zs};
+
+  if (!dict.empty()
+      && deflateSetDictionary(&zs, reinterpret_cast<const Bytef*>(dict.data()),
+                              static_cast<uInt>(dict.size())) != Z_OK)
+  {
+    ThrowDeflateError("cannot set dictionary");
+  }
+
+  const auto flush = b.last ? Z_FINISH : Z_SYNC_FLUSH;
+  zs.next_in  = reinterpret_cast<Bytef*>(b.in.data());
+  zs.avail_in = static_cast<uInt>(b.in.size());
+  b.out.resize(deflateBound(&zs, static_cast<uLong>(b.in.size())) + 16);
+  for (;;) {
+    zs.next_out  = reinterpret_cast<Bytef*>(b.out.data() + zs.total_out);
+    zs.avail_out = static_cast<uInt>(b.out.size() - zs.total_out);
+    const auto r = deflate(&zs, flush);
+    if (r == Z_STREAM_ERROR)
+      ThrowDeflateError("zlib error");
+    if (b.last ? (r == Z_STREAM_END) : (zs.avail_out != 0))
+      break;
+    b.out.resize(2 * b.out.size());
+  }
+  b.out.resize(zs.total_out);
+  b.crc = static_cast<std::uint32_t>(
+              crc32(0L, reinterpret_cast<const Bytef*>(b.in.data()),
+                    static_cast<uInt>(b.in.size())));
+} // Compress
+
+} // local
+
+DeflateStream::DeflateStream(DeflateReadFn read, int level, int threads)
+  : _read{std::move(read)}, _level{level}, _threads{ThreadCount(threads)},
+    _blocks(static_cast<std::size_t>(_threads) * BlocksPerThread),
+    _crc{static_cast<std::uint32_t>(crc32(0L, Z_NULL, 0))}
+{ }
+
+void DeflateStream::round() {
+  _numBlocks = 0;
+  while (_numBlocks != _blocks.size() && !_done) {
+    auto& b = _blocks[_numBlocks++];
+    b.in.resize(BlockSize);
+    b.in.resize(Fill(_read, b.in.data(), BlockSize));
+    _done = b.last = (b.in.size() != BlockSize);
+  }
+  ParallelFor(_numBlocks, _threads, [&](std::size_t k) {
+    const auto prev = (k == 0) ? std::string_view{_dict}
+                               : Tail(_blocks[k-1].in);
+    Compress(_blocks[k], prev, _level);
+  });
+  for (auto k = std::size_t{0}; k != _numBlocks; ++k) {
+    const auto& b = _blocks[k];
+    _size += b.in.size();
+    _crc = static_cast<std::uint32_t>(
+               crc32_combine(_crc, b.crc, static_cast<z_off_t>(b.in.size())));
+  }
+  _dict.assign(Tail(_blocks[_numBlocks-1].in));
+  _block = 0;
+  _pos   = 0;
+} // round
+
+std::size_t DeflateStream::read(void* buf, std::size_t size) {
+  auto* out = static_cast<char*>(buf);
+  auto n = std::size_t{0};
+  while (n != size) {
+    if (_block == _numBlocks) {
+      if (_done)
+        break;
+      round();
+      continue;
+    }
+    const auto& b = _blocks[_block];
+    const auto take = std::min(size - n, b.out.size() - _pos);
+    std::memcpy(out + n, b.out.data() + _pos, take);
+    n    += take;
+    _pos += take;
+    if (_pos == b.out.size()) {
+      ++_block;
+      _pos = 0;
+    }
+  }
+  if (_done && _block == _numBlocks && !_blocks.empty()) {
+    // All handed out: the buffers are not needed again.
+    _blocks = {};
+    _dict   = {};
+    _numBlocks = _block = 0;
+  }
+  return n;
+} // read
+
+Deflated ParallelDeflate(const DeflateReadFn& read, int level, int threads) {
+  auto stream = DeflateStream{read, level, threads};
+  auto result = Deflated{};
+  auto buf = std::string(BlockSize, '\0');
+  while (const auto n = stream.read(buf.data(), buf.size()))
+    result.data.append(buf.data(), n);
+  result.size = stream.size();
+  result.crc  = stream.crc();
+  return result;
+} // ParallelDeflate
+
+} // tjg
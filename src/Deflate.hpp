@@ -0,0 +1,75 @@
+/// @file
+/// Raw deflate compression, in blocks spread over several threads.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// The input is cut into fixed-size blocks that are compressed
+/// independently, each primed with the 32 KiB that precede it as its
+/// dictionary, and ended with a sync flush so the compressed blocks simply
+/// concatenate, as pigz does.  The result is one ordinary deflate stream
+/// that any inflater reads; it is a little larger than a single-threaded
+/// stream at the same level, because matches cannot reach back past the
+/// dictionary.  The output does not depend on the thread count.
+/// DeflateStream hands the compressed data out as each round of blocks is
+/// done, so only a round's worth is ever held; ParallelDeflate collects it.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace tjg {
+
+struct Deflated {
+  std::string   data;      ///< raw deflate stream, no zlib or gzip header
+  std::uint64_t size = 0;  ///< uncompressed bytes
+  std::uint32_t crc  = 0;  ///< CRC-32 of the uncompressed bytes
+}; // Deflated
+
+/// Fills up to `size` bytes of `buf`; returns 0 at end of data.
+using DeflateReadFn = std::function<std::size_t(void* buf, std::size_t size)>;
+
+/// Compresses everything `read` yields at zlib `level` (1-9, or -1 for
+/// zlib's default) on up to `threads` threads, 0 for one per CPU.  Input is
+/// pulled, and compressed, one round of blocks at a time as read() needs
+/// more output.  Exceptions from `read` propagate from read().
+class DeflateStream {
+  struct Block {
+    std::string in;
+    std::string out;
+    std::uint32_t crc = 0;
+    bool last = false;
+  }; // Block
+
+  DeflateReadFn _read;
+  int _level;
+  int _threads;
+  std::vector<Block> _blocks;
+  std::size_t _numBlocks = 0;  // in the current round
+  std::size_t _block = 0;      // being handed out
+  std::size_t _pos   = 0;      // within its output
+  std::string _dict;           // the input just before the current round
+  std::uint64_t _size = 0;
+  std::uint32_t _crc  = 0;
+  bool _done = false;          // `read` is exhausted
+
+  void round();
+
+public:
+  DeflateStream(DeflateReadFn read, int level, int threads);
+
+  /// Copies up to `size` bytes of the raw deflate stream into `buf`;
+  /// returns 0 at the end.
+  std::size_t read(void* buf, std::size_t size);
+
+  /// Uncompressed bytes, and their CRC-32; final once read() returns 0.
+  std::uint64_t size() const noexcept { return _size; }
+  std::uint32_t crc()  const noexcept { return _crc;  }
+}; // DeflateStream
+
+/// All of a DeflateStream's output at once.
+Deflated ParallelDeflate(const DeflateReadFn& read, int level, int threads);
+
+} // tjg
@@ -1,9 +1,19 @@
 #include "FarmDb.hpp"
 #include "FarmGeo.hpp"
 #include "BoundarySwaths.hpp"
+#include "InsetCache.hpp"
+#include "parallel.hpp"
+#include "Stats.hpp"
 
 #include <format>
+#include <memory>
 #include <string>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
 
 namespace farm_db {
 
@@ -64,37 +74,309 @@ const char* Name(Swath::Method x) noexcept {
   }
 } // Name(Swath::Method)
 
-void Field::inset(const std::string& insetName, Distance dist) {
-  swaths.clear();
+namespace {
+
+// Ring mode: the rings of an inset polygon, each swath a closed path.
+auto& Outer (geo::Polygon& poly) { return poly.outer();  }
+auto& Inners(geo::Polygon& poly) { return poly.inners(); }
+
+std::size_t NumSwaths(const geo::MultiPolygon& mp) noexcept {
+  auto n = std::size_t{0};
+  for (const auto& poly: mp)
+    n += 1 + poly.inners().size();
+  return n;
+} // NumSwaths
+
+// A ring and a path are the same vector underneath, so the inset's points
+// become the swath's without a copy.
+void AddRingSwaths(std::vector<Swath>& swaths, const std::string& name,
+                   Coords& ring)
+  { static_cast<Coords&>(swaths.emplace_back(name).path) = std::move(ring); }
+
+// Edge mode: the same rings split at their corners, one swath per edge,
+// named "<ring name> E<k>".
+geo::MultiPath& Outer(PolyEdges& poly) { return poly.front(); }
+
+std::span<geo::MultiPath> Inners(PolyEdges& poly)
+  { return std::span{poly}.subspan(1); }
+
+std::size_t NumSwaths(const InsetEdges& edges) noexcept {
+  auto n = std::size_t{0};
+  for (const auto& poly: edges) {
+    for (const auto& ring: poly)
+      n += ring.size();
+  }
+  return n;
+} // NumSwaths
+
+void AddRingSwaths(std::vector<Swath>& swaths, const std::string& name,
+                   geo::MultiPath& edges)
+{
+  int k = 0;
+  for (auto& edge: edges) {
+    swaths.emplace_back(std::format("{} E{}", name, ++k)).path
+                                                          = std::move(edge);
+  }
+} // AddRingSwaths
+
+// Names and appends the inset rings of every part of a field, moving their
+// points into the swaths.  Kept apart from the geometry so the serial and
+// parallel paths number swaths alike.  `Inset` is geo::MultiPolygon or
+// InsetEdges.
+template<class Inset>
+void AssignInsetSwaths(Field& field, const std::string& insetName,
+                       std::span<Inset> partSwaths)
+{
+  auto& swaths = field.swaths;
   int f = 0;
   int i = 0;
-  for (const auto& part: parts) {
-    auto geoPolys = farm_db::BoundarySwaths(part, dist);
+  for (auto& geoPolys: partSwaths) {
     auto partName = insetName;
     if (++f != 1)
       partName += " F" + std::to_string(f);
     int n = 0;
     bool useSuffix = (geoPolys.size() > 1);
-    for (const auto& geoPoly: geoPolys) {
+    for (auto& geoPoly: geoPolys) {
       auto swathName = partName;
       if (useSuffix)
         swathName += "_" + std::to_string(++n);
-      auto& swath = swaths.emplace_back(swathName);
-      swath.path = geo::MakePath(geoPoly.outer());
-      for (const auto& geoRing: geoPoly.inners()) {
+      AddRingSwaths(swaths, swathName, Outer(geoPoly));
+      for (auto& geoRing: Inners(geoPoly)) {
         auto innerName = std::format("{} I{}", insetName , ++i);
-        auto& swath2 = swaths.emplace_back(innerName);
-        swath2.path = geo::MakePath(geoRing);
+        AddRingSwaths(swaths, innerName, geoRing);
       }
     }
   }
+} // AssignInsetSwaths
+
+// Replaces the field's swaths with every pass, pass by pass.  `byPart[p][k]`
+// is pass k of part p.  With several passes each is named "<name> P<k>".
+template<class Inset>
+void AssignInsetPasses(Field& field, const std::string& insetName,
+                       std::size_t nPasses,
+                       std::vector<std::vector<Inset>>& byPart)
+{
+  auto total = std::size_t{0};
+  for (const auto& passes: byPart) {
+    for (const auto& pass: passes)
+      total += NumSwaths(pass);
+  }
+  field.swaths.clear();
+  field.swaths.reserve(total);
+  auto partSwaths = std::vector<Inset>(byPart.size());
+  for (auto k = std::size_t{0}; k != nPasses; ++k) {
+    for (auto p = std::size_t{0}; p != byPart.size(); ++p)
+      partSwaths[p] = std::move(byPart[p][k]);
+    const auto passName = (nPasses > 1)
+                        ? std::format("{} P{}", insetName, k+1) : insetName;
+    AssignInsetSwaths(field, passName, std::span<Inset>{partSwaths});
+  }
+} // AssignInsetPasses
+
+// Validates part `p` of `field`, already projected into `poly`, unless it
+// has been before on this plane or the options trust it.
+void CheckPart(const Field& field, std::size_t p, const xy::Polygon& poly,
+               const InsetOptions& options)
+{
+  auto& valid = field.planarParts().valid[p];
+  if (valid || options.trusted)
+    return;
+  stage::Validate(poly);
+  valid = 1;
+} // CheckPart
+
+// Part `p` of `field` on the plane of `proj`, projected and validated on
+// first use.
+const xy::Polygon& WarmPart(const Field& field, std::size_t p,
+                            const Projection& proj,
+                            const InsetOptions& options)
+{
+  auto& slot = field.planarParts().parts[p];
+  if (!slot) {
+    auto poly = proj.forward(field.parts[p]);
+    CheckPart(field, p, poly, options);
+    slot = std::move(poly);
+  }
+  return *slot;
+} // WarmPart
+
+// Part `p` of `field` on the plane of `proj`, validated once, in a buffer
+// each thread reuses from one part to the next.
+const xy::Polygon& ColdPart(const Field& field, std::size_t p,
+                            const Projection& proj,
+                            const InsetOptions& options)
+{
+  thread_local auto scratch = xy::Polygon{};
+  proj.forward(field.parts[p], scratch);
+  CheckPart(field, p, scratch, options);
+  return scratch;
+} // ColdPart
+
+// Every pass of part `p` of `field`, as rings or as edges.
+template<class Inset>
+std::vector<Inset> InsetPart(const Field& field, std::size_t p,
+                             const Projection& proj,
+                             std::span<const Distance> dists,
+                             const InsetOptions& options)
+{
+  const auto& join = options.join;
+  const auto tol = DefaultSimplifyTol;
+  const auto& valid = options.warm ? WarmPart(field, p, proj, options)
+                                   : ColdPart(field, p, proj, options);
+  if constexpr (std::is_same_v<Inset, InsetEdges>)
+    return ValidBoundaryEdges(valid, proj, dists, tol, join);
+  else
+    return ValidBoundarySwaths(valid, proj, dists, tol, join);
+} // InsetPart
+
+template<class Inset>
+void InsetField(Field& field, const std::string& insetName,
+                std::span<const Distance> dists, const InsetOptions& options)
+{
+  auto byPart = std::vector<std::vector<Inset>>{};
+  byPart.reserve(field.parts.size());
+  if (!field.parts.empty()) {
+    const auto& proj = field.projection(options.plane);
+    for (auto p = std::size_t{0}; p != field.parts.size(); ++p)
+      byPart.push_back(InsetPart<Inset>(field, p, proj, dists, options));
+  }
+  AssignInsetPasses(field, insetName, dists.size(), byPart);
+} // InsetField
+
+// Insets `fields[f]` for every f in `which`.
+template<class Inset>
+void InsetFields(std::span<const std::unique_ptr<Field>> fields,
+                 std::span<const std::size_t> which,
+                 const std::string& insetName,
+                 std::span<const Distance> dists,
+                 const InsetOptions& options, int threads,
+                 std::vector<Stats>* fieldStats)
+{
+  // Every part of every field is an independent job, so one large field
+  // does not hold up the others.  Results land in per-part slots and are
+  // named afterwards in field order.
+  struct Job {
+    std::size_t field;
+    std::size_t part;
+    Stats stats;
+  }; // Job
+
+  // Projections are built here, before the workers start, and only read
+  // by them.
+  auto jobs = std::vector<Job>{};
+  auto projections = std::vector<const Projection*>(fields.size(), nullptr);
+  auto results = std::vector<std::vector<std::vector<Inset>>>(fields.size());
+  for (auto f: which) {
+    const auto nParts = fields[f]->parts.size();
+    if (nParts != 0) {
+      auto scope = StatsScope{fieldStats ? &(*fieldStats)[f] : nullptr};
+      projections[f] = &fields[f]->projection(options.plane);
+    }
+    results[f].resize(nParts);
+    for (auto p = std::size_t{0}; p != nParts; ++p)
+      jobs.push_back(Job{f, p, {}});
+  }
+
+  // Each job records into its own Stats; they are summed per field after.
+  tjg::ParallelFor(jobs.size(), threads, [&](std::size_t j) {
+    auto& job = jobs[j];
+    auto scope = StatsScope{fieldStats ? &job.stats : nullptr};
+    results[job.field][job.part] = InsetPart<Inset>(
+                *fields[job.field], job.part, *projections[job.field],
+                dists, options);
+  });
+
+  if (fieldStats) {
+    for (const auto& job: jobs)
+      (*fieldStats)[job.field] += job.stats;
+  }
+
+  for (auto f: which)
+    AssignInsetPasses(*fields[f], insetName, dists.size(), results[f]);
+} // InsetFields
+
+} // local
+
+const Projection& Field::projection(PlaneKind kind) {
+  if (!_projection || _projection->kind() != kind) {
+    _projection = std::make_shared<const Projection>(std::span{parts}, kind);
+    _planar = std::make_shared<PlanarParts>();
+    _planar->parts.resize(parts.size());
+    _planar->valid.resize(parts.size());
+  }
+  return *_projection;
+} // projection
+
+void Field::inset(const std::string& insetName, Distance dist)
+  { inset(insetName, std::span{&dist, 1}); }
+
+void Field::inset(const std::string& insetName,
+                  std::span<const Distance> dists,
+                  const InsetOptions& options)
+{
+  if (options.style == InsetStyle::Edges)
+    InsetField<InsetEdges>(*this, insetName, dists, options);
+  else
+    InsetField<geo::MultiPolygon>(*this, insetName, dists, options);
 } // inset
 
-void FarmDb::inset(const std::string& insetName, Distance dist) {
-  for (auto& field: fields)
-    field->inset(insetName, dist);
+void FarmDb::inset(const std::string& insetName, Distance dist, int threads)
+  { inset(insetName, std::span{&dist, 1}, threads); }
+
+void FarmDb::inset(const std::string& insetName,
+                   std::span<const Distance> dists, int threads,
+                   std::vector<Stats>* fieldStats,
+                   const InsetOptions& options, InsetCache* cache)
+{
+  if (fieldStats)
+    fieldStats->assign(fields.size(), Stats{});
+
+  auto keys = std::vector<InsetCache::EntryKey>(cache ? fields.size() : 0);
+  auto todo = std::vector<std::size_t>{};
+  todo.reserve(fields.size());
+  for (auto f = std::size_t{0}; f != fields.size(); ++f) {
+    if (cache) {
+      keys[f] = InsetCache::Key(*fields[f], insetName, dists, options);
+      if (cache->find(keys[f], fields[f]->swaths))
+        continue;
+    }
+    todo.push_back(f);
+  }
+
+  if (tjg::ThreadCount(threads) <= 1) {
+    for (auto f: todo) {
+      auto scope = StatsScope{fieldStats ? &(*fieldStats)[f] : nullptr};
+      fields[f]->inset(insetName, dists, options);
+    }
+  } else if (options.style == InsetStyle::Edges) {
+    InsetFields<InsetEdges>(fields, todo, insetName, dists, options,
+                            threads, fieldStats);
+  } else {
+    InsetFields<geo::MultiPolygon>(fields, todo, insetName, dists,
+                                   options, threads, fieldStats);
+  }
+
+  if (cache) {
+    for (auto f: todo)
+      cache->store(keys[f], fields[f]->swaths);
+  }
 } // inset
 
+void FarmDb::swap(FarmDb& rhs) noexcept {
+  using std::swap;
+  swap(arena,              rhs.arena);
+  swap(strings,            rhs.strings);
+  swap(versionMajor,       rhs.versionMajor);
+  swap(versionMinor,       rhs.versionMinor);
+  swap(dataTransferOrigin, rhs.dataTransferOrigin);
+  swap(swVendor,           rhs.swVendor);
+  swap(swVersion,          rhs.swVersion);
+  swap(customers,          rhs.customers);
+  swap(farms,              rhs.farms);
+  swap(fields,             rhs.fields);
+  swap(otherAttr,          rhs.otherAttr);
+} // swap
+
 void FarmDb::print(std::ostream& os) const {
   using namespace std;
   os << "\nCustomers\n";
@@ -5,6 +5,8 @@
 #pragma once
 
 #include "enum_help.hpp"
+#include "Arena.hpp"
+#include "StringPool.hpp"
 
 #include <boost/geometry/geometries/point.hpp>
 #include <boost/geometry/geometries/linestring.hpp>
@@ -19,13 +21,21 @@
 #include <mp-units/framework/quantity.h>
 
 #include <filesystem>
+#include <cmath>
+#include <cstdint>
+#include <iosfwd>
 #include <string>
 #include <vector>
 #include <string_view>
 #include <span>
+#include <stdexcept>
 #include <optional>
 #include <functional>
+#include <memory>
 #include <utility>
+#include <variant>
+
+namespace tjg { class XmlReader; }
 
 namespace farm_db {
 
@@ -48,14 +58,57 @@ using LonDeg = mp_units::quantity<units::longitude[units::deg]>;
 using Distance =
               mp_units::quantity<mp_units::isq::distance[mp_units::si::metre]>;
 
-struct LatLon {
-  LatDeg latitude;
-  LonDeg longitude;
+/// A point on the WGS84 spheroid.  By default each coordinate is a double.
+/// Built with FARM_DB_COMPACT_COORDS, each is instead a 32-bit count of
+/// 1e-7 degrees, halving the memory of every vertex for farms too big to
+/// keep in doubles.  Rounding moves each coordinate up to half a step, at
+/// most 5.6 mm, so a point moves at most 7.9 mm, diagonally at the equator:
+/// ISOXML allows nine decimals, but even RTK positions are only good to a
+/// centimetre or so.  A coordinate that is not finite or is beyond +/-90
+/// degrees of latitude or +/-180 of longitude cannot be stored and throws.
+/// Code sees degrees either way, through the accessors and the
+/// Boost.Geometry traits below, so no geometry code changes.
+class LatLon {
+#ifdef FARM_DB_COMPACT_COORDS
+  static constexpr double Scale = 1e7;
+  std::int32_t _lat;
+  std::int32_t _lon;
+  static std::int32_t Fixed(double v, double limit, const char* what) {
+    if (!(std::abs(v) <= limit))  // NaN included
+      throw std::runtime_error{std::string{"LatLon: "} + what
+                               + " out of range: " + std::to_string(v)};
+    return static_cast<std::int32_t>(std::lround(v * Scale));
+  } // Fixed
+public:
+  double lat() const noexcept { return _lat / Scale; }
+  double lon() const noexcept { return _lon / Scale; }
+  void lat(double v) { _lat = Fixed(v,  90.0, "latitude"); }
+  void lon(double v) { _lon = Fixed(v, 180.0, "longitude"); }
+#else
+  LatDeg _lat;
+  LonDeg _lon;
+public:
+  double lat() const noexcept { return _lat.numerical_value_in(units::deg); }
+  double lon() const noexcept { return _lon.numerical_value_in(units::deg); }
+  void lat(double v) { _lat = v * units::deg; }
+  void lon(double v) { _lon = v * units::deg; }
+#endif
   LatLon() = default;
-  LatLon(LatDeg lat_, LonDeg lon_) : latitude{lat_}, longitude(lon_) { }
+  LatLon(LatDeg lat_, LonDeg lon_) {
+    lat(lat_.numerical_value_in(units::deg));
+    lon(lon_.numerical_value_in(units::deg));
+  }
+  LatDeg latitude()  const noexcept { return lat() * units::deg; }
+  LonDeg longitude() const noexcept { return lon() * units::deg; }
   auto operator<=>(const LatLon& rhs) const = default;
 }; // LatLon
 
+#ifdef FARM_DB_COMPACT_COORDS
+inline constexpr bool CompactCoords = true;
+#else
+inline constexpr bool CompactCoords = false;
+#endif
+
 } // farm_db
 
 namespace boost::geometry::traits {
@@ -77,18 +130,17 @@ struct dimension<farm_db::LatLon>
 template<std::size_t Dim>
 requires (Dim == 0 || Dim == 1)
 struct access<farm_db::LatLon, Dim> {
-  static constexpr auto deg = mp_units::si::degree;
-  static constexpr double get(const farm_db::LatLon& p) {
+  static double get(const farm_db::LatLon& p) {
     if constexpr (Dim == 0)
-      return p.longitude.numerical_value_in(deg);
+      return p.lon();
     else
-      return p.latitude.numerical_value_in(deg);
+      return p.lat();
   }
-  static constexpr void set(farm_db::LatLon& p, double v) {
+  static void set(farm_db::LatLon& p, double v) {
     if constexpr (Dim == 0)
-      p.longitude = v * deg;
+      p.lon(v);
     else
-      p.latitude  = v * deg;
+      p.lat(v);
   }
 }; // access
 
@@ -97,7 +149,7 @@ struct make<farm_db::LatLon> {
   static constexpr auto deg = mp_units::si::degree;
   using point_type = farm_db::LatLon;
   static constexpr auto is_specialized = true;
-  static constexpr point_type apply(double x, double y)
+  static point_type apply(double x, double y)
     { return point_type{y * deg, x * deg}; }
 }; // make
 
@@ -105,16 +157,27 @@ struct make<farm_db::LatLon> {
 
 namespace farm_db {
 
-using Path    = boost::geometry::model::linestring<LatLon>;
-using Polygon = boost::geometry::model::polygon<LatLon>;
-
+// Geometry draws from the arena of the FarmDb being read; see Arena.hpp.
+using Coords  = std::vector<LatLon, tjg::ArenaAllocator<LatLon>>;
+using Path    = boost::geometry::model::linestring<LatLon, std::vector,
+                                                   tjg::ArenaAllocator>;
+using Polygon = boost::geometry::model::polygon<LatLon, true, true,
+                    std::vector, std::vector,
+                    tjg::ArenaAllocator, tjg::ArenaAllocator>;
+
+/// An attribute kept only to be written back out.  Both strings are views
+/// into the StringPool of the FarmDb that holds it, so an Attribute must not
+/// outlive that FarmDb or be copied into another.
 struct Attribute {
-  std::string key;
-  std::string value;
-  Attribute(std::string_view k, const char* v)
-    : key{k}, value{v} { }
+  std::string_view key;
+  std::string_view value;
+  Attribute(std::string_view k, std::string_view v) : key{k}, value{v} { }
+  Attribute(tjg::StringPool& pool, std::string_view k, std::string_view v)
+    : key{pool.intern(k)}, value{pool.intern(v)} { }
 }; // Attribute
 
+using Attributes = std::vector<Attribute, tjg::ArenaAllocator<Attribute>>;
+
 struct Swath {
   enum class Type { AB = 1, APlus, Curve, Pivot, Spiral };
   using TypeList = tjg::EnumList<Type, Type::AB, Type::APlus, Type::Curve,
@@ -149,7 +212,7 @@ struct Swath {
   std::optional<HdgDeg>    heading;
   std::optional<Method>    method;
   Path path;
-  std::vector<Attribute> otherAttr;
+  Attributes otherAttr;
   Swath() = default;
   explicit Swath(std::string_view name_, Type type_ = Type::Curve)
     : name{name_}, type{type_} { }
@@ -163,6 +226,69 @@ const char* Name(Swath::Method    x) noexcept;
 
 struct Customer;
 struct Farm;
+class InsetCache;
+class Projection;
+struct PlanarParts;
+struct Stats;
+
+/// How Field::inset and FarmDb::inset turn each inset ring into swaths.
+enum class InsetStyle {
+  Rings, ///< one closed swath per ring
+  Edges  ///< the ring split at its corners, one open swath per edge
+}; // InsetStyle
+
+/// Inset corners become arcs of `points` segments per full circle.
+struct RoundJoin { int points = 32; };
+
+/// Inset corners stay sharp, one vertex each; a corner reaching farther
+/// than `limit` times the inset distance is cut off.  Rectangular fields
+/// then carry a few vertices per ring through buffering, validation,
+/// simplification and output instead of an arc at every corner.
+struct MiterJoin { double limit = 5.0; };
+
+using InsetJoin = std::variant<RoundJoin, MiterJoin>;
+
+/// The plane a field is inset in.
+enum class PlaneKind {
+  Aeqd,    ///< ellipsoidal azimuthal-equidistant, through proj
+  Tangent  ///< tangent to the ellipsoid at the field's centre; much faster,
+           ///< and lengths within 10 km of the centre are off by < 1.3e-6
+}; // PlaneKind
+
+/// Settings shared by every field of one inset.
+struct InsetOptions {
+  InsetStyle style = InsetStyle::Rings;
+  InsetJoin  join  = RoundJoin{};
+  PlaneKind  plane = PlaneKind::Aeqd;
+  /// Keep each field's parts projected and validated for later insets of
+  /// the same plane; for a process that insets one FarmDb many times.
+  bool       warm  = false;
+  /// Take every part as valid without checking; for re-processing output
+  /// this program wrote.  An invalid part then fails later, or insets wrong.
+  bool       trusted = false;
+}; // InsetOptions
+
+/// How FarmDb::writeWkt formats its output.
+struct WktOptions {
+  int precision = 15; ///< significant digits; 0 for the shortest exact form
+  int threads   = 1;  ///< formatting threads; 0 for one per CPU
+}; // WktOptions
+
+/// How FarmDb::writeZip compresses its entries and which it writes.
+struct ZipOptions {
+  enum class Compression {
+    Store,    ///< no compression
+    Fast,     ///< deflate level 1
+    Default,  ///< deflate level 6
+    Best,     ///< deflate level 9
+    Zstd      ///< zstd, if libzip was built with it
+  }; // Compression
+  Compression compression = Compression::Default;
+  int  threads = 1;        ///< deflate threads; 0 for one per CPU
+  bool wkt     = false;    ///< also TASKDATA/TASKDATA.wkt, as writeWkt
+  bool fdb     = false;    ///< also TASKDATA/TASKDATA.fdb, as writeFdb
+  WktOptions wktOptions = {};
+}; // ZipOptions
 
 struct Field {
   std::string name;
@@ -170,18 +296,39 @@ struct Field {
   Farm* farm = nullptr;
   std::vector<Polygon> parts;
   std::vector<Swath>   swaths;
-  std::vector<Attribute> otherAttr;
+  Attributes otherAttr;
   Field() = default;
   explicit Field(std::string_view name_) : name{name_} { }
   void inset(const std::string& name, Distance dist);
+  /// One set of swaths per distance, in order; `dists` must be increasing.
+  void inset(const std::string& name, std::span<const Distance> dists,
+             const InsetOptions& options = {});
   void sortByArea();
+
+  /// Local plane for this field's geometry, built on first use and kept
+  /// for later insets of the same kind.  Call resetProjection() after
+  /// changing `parts`.
+  const Projection& projection(PlaneKind kind = PlaneKind::Aeqd);
+  void resetProjection() noexcept {
+    _projection.reset();
+    _planar.reset();
+  }
+
+  /// One empty slot per part, made with the projection, for parts projected
+  /// onto its plane and validated; see BoundarySwaths.hpp.  Different parts
+  /// may be filled from different threads.
+  PlanarParts& planarParts() const noexcept { return *_planar; }
+
+private:
+  std::shared_ptr<const Projection> _projection;
+  std::shared_ptr<PlanarParts> _planar;
 }; // Field
 
 struct Farm {
   std::string name;
   Customer* customer = nullptr;
   std::vector<Field*> fields;
-  std::vector<Attribute> otherAttr;
+  Attributes otherAttr;
   Farm() = default;
   explicit Farm(std::string_view name_) : name{name_} { }
 }; // Farm
@@ -189,12 +336,18 @@ struct Farm {
 struct Customer {
   std::string name;
   std::vector<Farm*> farms;
-  std::vector<Attribute> otherAttr;
+  Attributes otherAttr;
   Customer() = default;
   explicit Customer(std::string_view name_) : name{name_} { }
 }; // Customer
 
 struct FarmDb {
+  /// Holds the geometry read from a file.  Declared first so it outlives
+  /// everything allocated from it.
+  std::unique_ptr<tjg::Arena> arena = std::make_unique<tjg::Arena>();
+  /// Holds the strings of every Attribute; see Attribute.
+  std::unique_ptr<tjg::StringPool> strings =
+                                      std::make_unique<tjg::StringPool>();
   int versionMajor       =  3;
   int versionMinor       =  0;
   int dataTransferOrigin = -1;
@@ -203,16 +356,46 @@ struct FarmDb {
   std::vector<std::unique_ptr<Customer>> customers;
   std::vector<std::unique_ptr<Farm>>     farms;
   std::vector<std::unique_ptr<Field>>    fields;
-  std::vector<Attribute> otherAttr;
+  Attributes otherAttr;
   FarmDb() = default;
+  FarmDb(FarmDb&&) = default;
+  // Member-wise assignment would free the old arena before the geometry
+  // that lives in it.
+  FarmDb& operator=(FarmDb&& rhs) noexcept {
+    auto tmp = FarmDb{std::move(rhs)};
+    swap(tmp);
+    return *this;
+  } // move
+  void swap(FarmDb& rhs) noexcept;
   void print(std::ostream& os) const;
-  void inset(const std::string& name, Distance dist);
+  void inset(const std::string& name, Distance dist, int threads = 1);
+  /// With `fieldStats`, it is resized to one Stats per field and filled.
+  /// With `cache`, fields found in it take the cached swaths and the rest
+  /// are inset and stored; unchanged fields then cost only a hash.
+  void inset(const std::string& name, std::span<const Distance> dists,
+             int threads = 1, std::vector<Stats>* fieldStats = nullptr,
+             const InsetOptions& options = {},
+             InsetCache* cache = nullptr);
   void writeXml(const std::filesystem::path& output) const;
-  void writeWkt(const std::filesystem::path& output) const;
-  void writeZip(const std::filesystem::path& output) const;
+  /// A name ending in ".gz" is gzip-compressed as it is written.
+  void writeWkt(const std::filesystem::path& output,
+                const WktOptions& options = {}) const;
+  void writeZip(const std::filesystem::path& output,
+                const ZipOptions& options = {}) const;
+  void writeFdb(const std::filesystem::path& output) const;
+  /// Boundaries to `output` (.shp, .shx, .dbf, .cpg) in the schema ReadShp
+  /// reads, and swaths as polylines to "<stem>_swaths.shp" beside it.
+  void writeShp(const std::filesystem::path& output) const;
+  /// The same two sets in one "<name>.shp.zip", boundaries first so that
+  /// ReadZip reads them back.
+  void writeShpZip(const std::filesystem::path& output) const;
   static FarmDb ReadXml(const std::filesystem::path& input);
-  static FarmDb ReadShp(const std::filesystem::path& input);
-  static FarmDb ReadZip(const std::filesystem::path& input);
+  static FarmDb ReadXml(tjg::XmlReader& xml);
+  /// With `threads` other than 1, shapefile polygons are decoded on that
+  /// many threads (0 for one per CPU) before being linked in order.
+  static FarmDb ReadShp(const std::filesystem::path& input, int threads = 1);
+  static FarmDb ReadZip(const std::filesystem::path& input, int threads = 1);
+  static FarmDb ReadFdb(const std::filesystem::path& input);
 }; // FarmDb
 
 } // farm_db
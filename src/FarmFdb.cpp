@@ -0,0 +1,651 @@
+/// @file
+/// Binary FarmDb cache (.fdb).
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// The file is a fixed header followed by flat, 8-byte aligned sections:
+/// interned strings, attributes, customers, farms, fields, polygon parts,
+/// rings, swaths and finally every coordinate as (lat, lon) doubles.  Records
+/// refer to one another by index, so loading is a bounds-checked walk of the
+/// tables plus one bulk copy per ring or path.  Integers and doubles are in
+/// the writer's native byte order, which the header records.
+#include "FarmFdb.hpp"
+#include "MappedFile.hpp"
+
+#include <gsl-lite/gsl-lite.hpp>
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace gsl = gsl_lite;
+
+namespace farm_db {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+namespace fdb {
+
+constexpr auto Magic     = std::array<char, 8>{
+                              'F','A','R','M','D','B','\0','\x1a'};
+constexpr auto ByteOrder = std::uint32_t{0x01020304};
+constexpr auto Version   = std::uint32_t{1};
+constexpr auto NoIndex   = std::int32_t{-1};
+constexpr auto NoEnum    = std::int32_t{-1};
+
+enum Sec {
+  StrOffsets, StrData, Attrs, Customers, Farms, Fields, Parts, Rings, Swaths,
+  Points, NumSections
+};
+
+struct Section {
+  std::uint64_t offset;
+  std::uint64_t count;
+}; // Section
+
+struct Range {
+  std::uint32_t begin;
+  std::uint32_t count;
+}; // Range
+
+struct Header {
+  std::array<char, 8> magic;
+  std::uint32_t byteOrder;
+  std::uint32_t version;
+  std::int32_t  versionMajor;
+  std::int32_t  versionMinor;
+  std::int32_t  dataTransferOrigin;
+  std::uint32_t swVendor;
+  std::uint32_t swVersion;
+  Range         attrs;
+  std::uint32_t reserved;
+  std::array<Section, NumSections> sections;
+}; // Header
+
+struct AttrRec     { std::uint32_t key, value; };
+struct CustomerRec { std::uint32_t name; Range attrs; };
+struct FarmRec     { std::uint32_t name; std::int32_t customer; Range attrs; };
+
+struct FieldRec {
+  std::uint32_t name;
+  std::int32_t  customer;
+  std::int32_t  farm;
+  Range parts;
+  Range swaths;
+  Range attrs;
+}; // FieldRec
+
+struct PartRec { Range rings; };  // first ring is the exterior
+struct RingRec { std::uint64_t begin, count; };
+
+struct SwathRec {
+  double        heading;
+  std::uint64_t pointBegin;
+  std::uint64_t pointCount;
+  std::uint32_t name;
+  std::int32_t  type;
+  std::int32_t  option;
+  std::int32_t  direction;
+  std::int32_t  extension;
+  std::int32_t  method;
+  std::uint32_t hasHeading;
+  Range         attrs;
+  std::uint32_t reserved;
+}; // SwathRec
+
+struct PointRec { double lat, lon; };
+
+static_assert(sizeof(Header)   == 48 + 16 * NumSections);
+static_assert(sizeof(SwathRec) == 64);
+static_assert(sizeof(FieldRec) == 36);
+static_assert(std::is_trivially_copyable_v<LatLon>
+              && (CompactCoords || sizeof(LatLon) == sizeof(PointRec)));
+
+constexpr std::size_t Align = 8;
+
+constexpr std::uint64_t Aligned(std::uint64_t n) noexcept
+  { return (n + Align - 1) & ~std::uint64_t{Align - 1}; }
+
+} // fdb
+
+[[noreturn]] void ThrowFdbError(const fs::path& path, const std::string& msg)
+  { throw std::runtime_error{path.generic_string() + ": " + msg}; }
+
+template<class E>
+std::int32_t EnumRec(const std::optional<E>& e) noexcept
+  { return e ? static_cast<std::int32_t>(*e) : fdb::NoEnum; }
+
+// ---------------------------------------------------------------------
+// Writing
+
+class FdbWriter {
+  const FarmDb& _db;
+  std::vector<std::string_view> _strings;
+  std::unordered_map<std::string_view, std::uint32_t> _stringIds;
+  std::vector<fdb::AttrRec>     _attrs;
+  std::vector<fdb::CustomerRec> _customers;
+  std::vector<fdb::FarmRec>     _farms;
+  std::vector<fdb::FieldRec>    _fields;
+  std::vector<fdb::PartRec>     _parts;
+  std::vector<fdb::RingRec>     _rings;
+  std::vector<fdb::SwathRec>    _swaths;
+  std::uint64_t _numPoints = 0;
+  std::uint32_t _swVendor  = 0;
+  std::uint32_t _swVersion = 0;
+  fdb::Range    _rootAttrs = {};
+
+  std::uint32_t intern(std::string_view s) {
+    auto [it, added] = _stringIds.try_emplace(
+                          s, gsl::narrow<std::uint32_t>(_strings.size()));
+    if (added)
+      _strings.push_back(s);
+    return it->second;
+  } // intern
+
+  fdb::Range attrs(const Attributes& v) {
+    const auto begin = gsl::narrow<std::uint32_t>(_attrs.size());
+    for (const auto& [k, val]: v)
+      _attrs.push_back({intern(k), intern(val)});
+    return {begin, gsl::narrow<std::uint32_t>(v.size())};
+  } // attrs
+
+  std::uint64_t points(std::size_t n) {
+    const auto begin = _numPoints;
+    _numPoints += n;
+    return begin;
+  } // points
+
+  void ring(const Coords& r) {
+    const auto n = r.size();
+    _rings.push_back({points(n), n});
+  } // ring
+
+public:
+  // A run of the file: bytes as they are, or coordinates to be widened to
+  // PointRecs.
+  struct Piece {
+    std::span<const std::byte> bytes;
+    std::span<const LatLon>    points;
+    std::size_t size() const noexcept
+      { return bytes.size() + points.size() * sizeof(fdb::PointRec); }
+  }; // Piece
+
+private:
+  fdb::Header _hdr = {};
+  std::vector<std::uint64_t> _strOffsets;
+  std::vector<Piece> _pieces;  // views this writer and the FarmDb
+
+  void layout();
+
+public:
+  explicit FdbWriter(const FarmDb& db);
+  FdbWriter(const FdbWriter&) = delete;
+  FdbWriter& operator=(const FdbWriter&) = delete;
+
+  /// The whole file, in order.
+  std::span<const Piece> pieces() const noexcept { return _pieces; }
+
+  void write(std::ostream& os) const;
+}; // FdbWriter
+
+FdbWriter::FdbWriter(const FarmDb& db) : _db{db} {
+  _swVendor  = intern(db.swVendor);
+  _swVersion = intern(db.swVersion);
+  _rootAttrs = attrs(db.otherAttr);
+  auto custIdx = std::unordered_map<const Customer*, std::int32_t>{};
+  auto farmIdx = std::unordered_map<const Farm*, std::int32_t>{};
+  for (const auto& c: db.customers) {
+    custIdx.emplace(c.get(), gsl::narrow<std::int32_t>(_customers.size()));
+    _customers.push_back({intern(c->name), attrs(c->otherAttr)});
+  }
+  auto indexOf = [](const auto& map, const auto* p) {
+    auto it = map.find(p);
+    return (it != map.end()) ? it->second : fdb::NoIndex;
+  };
+  for (const auto& f: db.farms) {
+    farmIdx.emplace(f.get(), gsl::narrow<std::int32_t>(_farms.size()));
+    _farms.push_back({intern(f->name), indexOf(custIdx, f->customer),
+                      attrs(f->otherAttr)});
+  }
+  for (const auto& f: db.fields) {
+    auto rec = fdb::FieldRec{};
+    rec.name     = intern(f->name);
+    rec.customer = indexOf(custIdx, f->customer);
+    rec.farm     = indexOf(farmIdx, f->farm);
+    rec.parts  = {gsl::narrow<std::uint32_t>(_parts.size()),
+                  gsl::narrow<std::uint32_t>(f->parts.size())};
+    for (const auto& part: f->parts) {
+      _parts.push_back({{gsl::narrow<std::uint32_t>(_rings.size()),
+                  gsl::narrow<std::uint32_t>(1 + part.inners().size())}});
+      ring(part.outer());
+      for (const auto& inner: part.inners())
+        ring(inner);
+    }
+    rec.swaths = {gsl::narrow<std::uint32_t>(_swaths.size()),
+                  gsl::narrow<std::uint32_t>(f->swaths.size())};
+    for (const auto& s: f->swaths) {
+      using mp_units::si::unit_symbols::deg;
+      auto sw = fdb::SwathRec{};
+      sw.name       = intern(s.name);
+      sw.type       = static_cast<std::int32_t>(s.type);
+      sw.option     = EnumRec(s.option);
+      sw.direction  = EnumRec(s.direction);
+      sw.extension  = EnumRec(s.extension);
+      sw.method     = EnumRec(s.method);
+      sw.hasHeading = s.heading.has_value();
+      sw.heading    = s.heading ? s.heading->numerical_value_in(deg) : 0.0;
+      sw.pointCount = s.path.size();
+      sw.pointBegin = points(s.path.size());
+      sw.attrs      = attrs(s.otherAttr);
+      _swaths.push_back(sw);
+    }
+    rec.attrs = attrs(f->otherAttr);
+    _fields.push_back(rec);
+  }
+  layout();
+} // ctor
+
+void FdbWriter::layout() {
+  using namespace fdb;
+  auto& hdr = _hdr;
+  hdr.magic              = Magic;
+  hdr.byteOrder          = ByteOrder;
+  hdr.version            = Version;
+  hdr.versionMajor       = _db.versionMajor;
+  hdr.versionMinor       = _db.versionMinor;
+  hdr.dataTransferOrigin = _db.dataTransferOrigin;
+  hdr.swVendor           = _swVendor;
+  hdr.swVersion          = _swVersion;
+  hdr.attrs              = _rootAttrs;
+
+  auto& strOffsets = _strOffsets;
+  strOffsets.reserve(_strings.size() + 1);
+  auto strBytes = std::uint64_t{0};
+  for (auto s: _strings) {
+    strOffsets.push_back(strBytes);
+    strBytes += s.size();
+  }
+  strOffsets.push_back(strBytes);
+
+  const auto counts = std::array<std::uint64_t, NumSections>{
+    strOffsets.size(), strBytes, _attrs.size(), _customers.size(),
+    _farms.size(), _fields.size(), _parts.size(),
+    _rings.size(), _swaths.size(), _numPoints
+  };
+  const auto sizes = std::array<std::uint64_t, NumSections>{
+    sizeof(std::uint64_t), 1, sizeof(AttrRec), sizeof(CustomerRec),
+    sizeof(FarmRec), sizeof(FieldRec), sizeof(PartRec), sizeof(RingRec),
+    sizeof(SwathRec), sizeof(PointRec)
+  };
+  auto offset = Aligned(sizeof(Header));
+  for (auto i = 0; i != NumSections; ++i) {
+    hdr.sections[i] = {offset, counts[i]};
+    offset = Aligned(offset + counts[i] * sizes[i]);
+  }
+
+  auto pos = std::uint64_t{0};
+  auto put = [&](const void* p, std::size_t n) {
+    if (n != 0)
+      _pieces.push_back({{static_cast<const std::byte*>(p), n}, {}});
+    pos += n;
+  };
+  auto pad = [&] {
+    static constexpr auto zeros = std::array<char, Align>{};
+    put(zeros.data(), Aligned(pos) - pos);
+  };
+  auto putVec = [&](const auto& v) {
+    pad();
+    put(v.data(), v.size() * sizeof(v[0]));
+  };
+  // The file always holds doubles, so compact coordinates are widened.
+  auto putPoints = [&](const auto& pts) {
+    if constexpr (!CompactCoords) {
+      put(pts.data(), pts.size() * sizeof(LatLon));
+    } else if (!pts.empty()) {
+      _pieces.push_back({{}, {pts.data(), pts.size()}});
+      pos += pts.size() * sizeof(PointRec);
+    }
+  };
+
+  put(&hdr, sizeof(hdr));
+  putVec(strOffsets);
+  pad();
+  for (auto s: _strings)
+    put(s.data(), s.size());
+  putVec(_attrs);
+  putVec(_customers);
+  putVec(_farms);
+  putVec(_fields);
+  putVec(_parts);
+  putVec(_rings);
+  putVec(_swaths);
+  pad();
+  // Coordinates are viewed straight in the FarmDb, in the order that the
+  // constructor numbered them.
+  for (const auto& f: _db.fields) {
+    for (const auto& part: f->parts) {
+      putPoints(part.outer());
+      for (const auto& inner: part.inners())
+        putPoints(inner);
+    }
+    for (const auto& s: f->swaths)
+      putPoints(s.path);
+  }
+  pad();
+} // layout
+
+void FdbWriter::write(std::ostream& os) const {
+  for (const auto& p: _pieces) {
+    if (!p.bytes.empty()) {
+      os.write(reinterpret_cast<const char*>(p.bytes.data()),
+               static_cast<std::streamsize>(p.bytes.size()));
+      continue;
+    }
+    auto buf = std::array<fdb::PointRec, 256>{};
+    for (auto i = std::size_t{0}; i != p.points.size(); ) {
+      auto n = std::size_t{0};
+      for (; n != buf.size() && i != p.points.size(); ++n, ++i)
+        buf[n] = {p.points[i].lat(), p.points[i].lon()};
+      os.write(reinterpret_cast<const char*>(buf.data()),
+               static_cast<std::streamsize>(n * sizeof(fdb::PointRec)));
+    }
+  }
+} // write
+
+// ---------------------------------------------------------------------
+// Reading
+
+class FdbReader {
+  const fs::path& _path;
+  std::span<const std::byte> _bytes;
+  fdb::Header _hdr;
+
+  [[noreturn]] void die(const std::string& msg) const
+    { ThrowFdbError(_path, "invalid FarmDb cache: " + msg); }
+
+  const std::byte* section(fdb::Sec s, std::size_t recSize) const {
+    const auto& sec = _hdr.sections[s];
+    if (sec.offset % fdb::Align != 0 || sec.offset > _bytes.size()
+        || sec.count > (_bytes.size() - sec.offset) / recSize)
+      die("section " + std::to_string(s) + " out of bounds");
+    return _bytes.data() + sec.offset;
+  } // section
+
+public:
+  FdbReader(const fs::path& path, std::span<const std::byte> bytes);
+
+  /// Record `i` of section `s`, copied out of the file.
+  template<class T>
+  T rec(fdb::Sec s, std::uint64_t i) const {
+    if (i >= _hdr.sections[s].count)
+      die("index out of range in section " + std::to_string(s));
+    auto out = T{};
+    std::memcpy(&out, section(s, sizeof(T)) + i * sizeof(T), sizeof(T));
+    return out;
+  } // rec
+
+  /// Throws unless `r` lies within section `s`.
+  void check(fdb::Sec s, fdb::Range r) const {
+    if (std::uint64_t{r.begin} + r.count > _hdr.sections[s].count)
+      die("range out of bounds in section " + std::to_string(s));
+  } // check
+
+  std::uint64_t count(fdb::Sec s) const { return _hdr.sections[s].count; }
+
+  const fdb::Header& header() const noexcept { return _hdr; }
+
+  std::string_view string(std::uint32_t id) const {
+    const auto lo = rec<std::uint64_t>(fdb::StrOffsets, id);
+    const auto hi = rec<std::uint64_t>(fdb::StrOffsets, std::uint64_t{id} + 1);
+    if (lo > hi || hi > _hdr.sections[fdb::StrData].count)
+      die("bad string offset");
+    const auto data = reinterpret_cast<const char*>(section(fdb::StrData, 1));
+    return {data + lo, static_cast<std::size_t>(hi - lo)};
+  } // string
+
+  /// Interned into `pool`, so they outlive the mapped file.
+  Attributes attrs(fdb::Range r, tjg::StringPool& pool) const {
+    check(fdb::Attrs, r);
+    auto out = Attributes{};
+    out.reserve(r.count);
+    for (auto i = r.begin; i != r.begin + r.count; ++i) {
+      const auto a = rec<fdb::AttrRec>(fdb::Attrs, i);
+      out.emplace_back(pool, string(a.key), string(a.value));
+    }
+    return out;
+  } // attrs
+
+  // Copies coordinates [begin, begin+count) into `out`, in bulk unless
+  // they are to be narrowed to compact ones.
+  template<class Container>
+  void points(std::uint64_t begin, std::uint64_t n, Container& out) const {
+    const auto total = _hdr.sections[fdb::Points].count;
+    if (begin > total || n > total - begin)
+      die("coordinates out of bounds");
+    out.resize(static_cast<std::size_t>(n));
+    if (n == 0)
+      return;
+    const auto base = section(fdb::Points, sizeof(fdb::PointRec))
+                    + begin * sizeof(fdb::PointRec);
+    if constexpr (!CompactCoords) {
+      std::memcpy(out.data(), base,
+                  static_cast<std::size_t>(n) * sizeof(fdb::PointRec));
+    } else {
+      for (auto i = std::size_t{0}; i != out.size(); ++i) {
+        auto r = fdb::PointRec{};
+        std::memcpy(&r, base + i * sizeof(r), sizeof(r));
+        out[i].lat(r.lat);
+        out[i].lon(r.lon);
+      }
+    }
+  } // points
+}; // FdbReader
+
+FdbReader::FdbReader(const fs::path& path, std::span<const std::byte> bytes)
+  : _path{path}, _bytes{bytes}
+{
+  if (_bytes.size() < sizeof(fdb::Header))
+    die("file too small");
+  std::memcpy(&_hdr, _bytes.data(), sizeof(_hdr));
+  if (_hdr.magic != fdb::Magic)
+    die("bad magic number");
+  if (_hdr.byteOrder != fdb::ByteOrder)
+    die("byte order mismatch");
+  if (_hdr.version != fdb::Version)
+    die("unsupported version " + std::to_string(_hdr.version));
+  const auto sizes = std::array<std::size_t, fdb::NumSections>{
+    sizeof(std::uint64_t), 1, sizeof(fdb::AttrRec), sizeof(fdb::CustomerRec),
+    sizeof(fdb::FarmRec), sizeof(fdb::FieldRec), sizeof(fdb::PartRec),
+    sizeof(fdb::RingRec), sizeof(fdb::SwathRec), sizeof(fdb::PointRec)
+  };
+  for (auto i = 0; i != fdb::NumSections; ++i)
+    (void) section(static_cast<fdb::Sec>(i), sizes[i]);
+  if (count(fdb::StrOffsets) == 0)
+    die("missing string table");
+} // ctor
+
+template<tjg::EnumWithName E>
+std::optional<E> EnumFromRec(const fs::path& path, std::int32_t v) {
+  if (v == fdb::NoEnum)
+    return std::nullopt;
+  auto e = tjg::enum_cast<E>(v);
+  if (!e)
+    ThrowFdbError(path, "invalid FarmDb cache: bad enum value "
+                        + std::to_string(v));
+  return e;
+} // EnumFromRec
+
+} // local
+
+struct FdbStream::Impl {
+  FdbWriter writer;
+  std::size_t piece = 0;  // being read
+  std::size_t pos   = 0;  // within it
+
+  explicit Impl(const FarmDb& db) : writer{db} { }
+}; // Impl
+
+FdbStream::FdbStream(const FarmDb& db) : _impl{std::make_unique<Impl>(db)} { }
+FdbStream::FdbStream(FdbStream&&) noexcept = default;
+FdbStream& FdbStream::operator=(FdbStream&&) noexcept = default;
+FdbStream::~FdbStream() noexcept = default;
+
+std::size_t FdbStream::read(void* buf, std::size_t size) {
+  auto& impl = *_impl;
+  const auto pieces = impl.writer.pieces();
+  auto* out = static_cast<std::byte*>(buf);
+  auto n = std::size_t{0};
+  while (n != size && impl.piece != pieces.size()) {
+    const auto& p = pieces[impl.piece];
+    auto take = std::size_t{0};
+    if (!p.bytes.empty()) {
+      take = std::min(size - n, p.bytes.size() - impl.pos);
+      std::memcpy(out + n, p.bytes.data() + impl.pos, take);
+    } else {
+      // Widened one point at a time; `buf` may end inside one.
+      const auto k   = impl.pos / sizeof(fdb::PointRec);
+      const auto off = impl.pos % sizeof(fdb::PointRec);
+      const auto rec = fdb::PointRec{p.points[k].lat(), p.points[k].lon()};
+      take = std::min(size - n, sizeof(rec) - off);
+      std::memcpy(out + n, reinterpret_cast<const std::byte*>(&rec) + off,
+                  take);
+    }
+    n        += take;
+    impl.pos += take;
+    if (impl.pos == p.size()) {
+      ++impl.piece;
+      impl.pos = 0;
+    }
+  }
+  return n;
+} // read
+
+void FarmDb::writeFdb(const fs::path& output) const {
+  if (output.extension() != ".fdb")
+    ThrowFdbError(output, "FarmDb::writeFdb: expected a .fdb file");
+  const auto writer = FdbWriter{*this};
+  auto os = std::ofstream{output, std::ios::binary};
+  if (os)
+    writer.write(os);
+  if (os)
+    os.close();
+  if (!os)
+    ThrowFdbError(output, "FarmDb::writeFdb: error writing file");
+} // FarmDb::writeFdb
+
+FarmDb FarmDb::ReadFdb(const fs::path& input) {
+  if (input.extension() != ".fdb")
+    ThrowFdbError(input, "FarmDb::ReadFdb: expected a .fdb file");
+  const auto file = tjg::MappedFile{input};
+  const auto rd = FdbReader{input, file.bytes()};
+  const auto& hdr = rd.header();
+
+  auto db = FarmDb{};
+  auto arena = tjg::ArenaScope{*db.arena};
+  auto& strings = *db.strings;
+  db.versionMajor       = hdr.versionMajor;
+  db.versionMinor       = hdr.versionMinor;
+  db.dataTransferOrigin = hdr.dataTransferOrigin;
+  db.swVendor  = rd.string(hdr.swVendor);
+  db.swVersion = rd.string(hdr.swVersion);
+  db.otherAttr = rd.attrs(hdr.attrs, strings);
+
+  const auto nCust = rd.count(fdb::Customers);
+  db.customers.reserve(nCust);
+  for (auto i = std::uint64_t{0}; i != nCust; ++i) {
+    const auto r = rd.rec<fdb::CustomerRec>(fdb::Customers, i);
+    auto cust = std::make_unique<Customer>(rd.string(r.name));
+    cust->otherAttr = rd.attrs(r.attrs, strings);
+    db.customers.emplace_back(std::move(cust));
+  }
+
+  auto customerAt = [&](std::int32_t idx) -> Customer* {
+    if (idx == fdb::NoIndex) return nullptr;
+    if (idx < 0 || static_cast<std::uint64_t>(idx) >= nCust)
+      ThrowFdbError(input, "invalid FarmDb cache: bad customer index");
+    return db.customers[static_cast<std::size_t>(idx)].get();
+  };
+
+  const auto nFarm = rd.count(fdb::Farms);
+  db.farms.reserve(nFarm);
+  for (auto i = std::uint64_t{0}; i != nFarm; ++i) {
+    const auto r = rd.rec<fdb::FarmRec>(fdb::Farms, i);
+    auto farm = std::make_unique<Farm>(rd.string(r.name));
+    farm->customer  = customerAt(r.customer);
+    farm->otherAttr = rd.attrs(r.attrs, strings);
+    if (farm->customer)
+      farm->customer->farms.push_back(farm.get());
+    db.farms.emplace_back(std::move(farm));
+  }
+
+  const auto nField = rd.count(fdb::Fields);
+  db.fields.reserve(nField);
+  for (auto i = std::uint64_t{0}; i != nField; ++i) {
+    using mp_units::si::unit_symbols::deg;
+    const auto r = rd.rec<fdb::FieldRec>(fdb::Fields, i);
+    auto field = std::make_unique<Field>(rd.string(r.name));
+    field->customer = customerAt(r.customer);
+    if (r.farm != fdb::NoIndex) {
+      if (r.farm < 0 || static_cast<std::uint64_t>(r.farm) >= nFarm)
+        ThrowFdbError(input, "invalid FarmDb cache: bad farm index");
+      field->farm = db.farms[static_cast<std::size_t>(r.farm)].get();
+    }
+    rd.check(fdb::Parts, r.parts);
+    field->parts.resize(r.parts.count);
+    for (auto p = std::uint32_t{0}; p != r.parts.count; ++p) {
+      const auto pr = rd.rec<fdb::PartRec>(fdb::Parts, r.parts.begin + p);
+      rd.check(fdb::Rings, pr.rings);
+      if (pr.rings.count == 0)
+        ThrowFdbError(input, "invalid FarmDb cache: part without rings");
+      auto& poly = field->parts[p];
+      const auto outer = rd.rec<fdb::RingRec>(fdb::Rings, pr.rings.begin);
+      rd.points(outer.begin, outer.count, poly.outer());
+      poly.inners().resize(pr.rings.count - 1);
+      for (auto k = std::uint32_t{1}; k != pr.rings.count; ++k) {
+        const auto ring = rd.rec<fdb::RingRec>(fdb::Rings, pr.rings.begin + k);
+        rd.points(ring.begin, ring.count, poly.inners()[k-1]);
+      }
+    }
+    rd.check(fdb::Swaths, r.swaths);
+    field->swaths.reserve(r.swaths.count);
+    for (auto s = std::uint32_t{0}; s != r.swaths.count; ++s) {
+      const auto sr = rd.rec<fdb::SwathRec>(fdb::Swaths, r.swaths.begin + s);
+      auto type = tjg::enum_cast<Swath::Type>(sr.type);
+      if (!type)
+        ThrowFdbError(input, "invalid FarmDb cache: bad swath type");
+      auto& swath = field->swaths.emplace_back(rd.string(sr.name), *type);
+      swath.option    = EnumFromRec<Swath::Option>   (input, sr.option);
+      swath.direction = EnumFromRec<Swath::Direction>(input, sr.direction);
+      swath.extension = EnumFromRec<Swath::Extension>(input, sr.extension);
+      swath.method    = EnumFromRec<Swath::Method>   (input, sr.method);
+      if (sr.hasHeading)
+        swath.heading = sr.heading * deg;
+      rd.points(sr.pointBegin, sr.pointCount, swath.path);
+      swath.otherAttr = rd.attrs(sr.attrs, strings);
+    }
+    field->otherAttr = rd.attrs(r.attrs, strings);
+    auto ptr = field.get();
+    db.fields.emplace_back(std::move(field));
+    if (ptr->farm)
+      ptr->farm->fields.push_back(ptr);
+  }
+  return db;
+} // FarmDb::ReadFdb
+
+} // farm_db
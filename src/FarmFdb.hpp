@@ -0,0 +1,30 @@
+/// @file
+/// Produces the FarmDb::writeFdb bytes a piece at a time.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+#pragma once
+#include "FarmDb.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace farm_db {
+
+/// The tables are built up front; they and the FarmDb's coordinates are
+/// then copied out by read() as they are, so the file itself is never held
+/// in memory.  The FarmDb must outlive the FdbStream and not change.
+class FdbStream {
+  struct Impl;
+  std::unique_ptr<Impl> _impl;
+
+public:
+  explicit FdbStream(const FarmDb& db);
+  FdbStream(FdbStream&&) noexcept;
+  FdbStream& operator=(FdbStream&&) noexcept;
+  ~FdbStream() noexcept;
+
+  /// Copies up to `size` bytes into `buf`; returns 0 at the end.
+  std::size_t read(void* buf, std::size_t size);
+}; // FdbStream
+
+} // farm_db
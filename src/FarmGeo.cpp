@@ -17,10 +17,10 @@ namespace farm_db {
 
 namespace geo {
 
-Path MakePath(const std::vector<LatLon>& pts)
+Path MakePath(const Coords& pts)
   { return Path{pts.begin(), pts.end()}; }
 
-Ring MakeRing(const std::vector<LatLon>& pts) {
+Ring MakeRing(const Coords& pts) {
   auto out = Ring{pts.begin(), pts.end()};
   ggl::correct(out);
   auto msg = std::string{};
@@ -29,7 +29,7 @@ Ring MakeRing(const std::vector<LatLon>& pts) {
   return out;
 } // MakeRing
 
-Hole MakeHole(const std::vector<LatLon>& pts) {
+Hole MakeHole(const Coords& pts) {
   auto out = Hole{pts.begin(), pts.end()};
   ggl::correct(out);
   auto msg = std::string{};
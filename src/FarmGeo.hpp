@@ -9,18 +9,20 @@ namespace ggl = boost::geometry;
 namespace geo {
 
 using Point        = LatLon;
-using LineString   = ggl::model::linestring<Point>;
+using LineString   = farm_db::Path;
 using PolyLine     = ggl::model::multi_linestring<LineString>;
-using Ring         = ggl::model::ring<Point, true >;
-using Hole         = ggl::model::ring<Point, false>;
-using Polygon      = ggl::model::polygon<Point>;
+using Ring = ggl::model::ring<Point, true,  true, std::vector,
+                             tjg::ArenaAllocator>;
+using Hole = ggl::model::ring<Point, false, true, std::vector,
+                             tjg::ArenaAllocator>;
+using Polygon      = farm_db::Polygon;
 using MultiPolygon = ggl::model::multi_polygon<Polygon>;
 using Path         = LineString;
 using MultiPath    = PolyLine;
 
-Path MakePath(const std::vector<LatLon>& pts);
-Ring MakeRing(const std::vector<LatLon>& pts);
-Hole MakeHole(const std::vector<LatLon>& pts);
+Path MakePath(const Coords& pts);
+Ring MakeRing(const Coords& pts);
+Hole MakeHole(const Coords& pts);
 
 } // geo
 
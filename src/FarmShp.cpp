@@ -1,5 +1,6 @@
 /// @file
-/// Reads ESRI Shapefiles (SHP/SHX/DBF) into a FarmDb.
+/// Reads ESRI Shapefiles (SHP/SHX/DBF) into a FarmDb, from disk or from
+/// memory through shapelib's SAHooks, and writes them.
 ///
 /// The importer is intentionally strict:
 /// - Only SHPT_POLYGON is accepted.
@@ -8,21 +9,45 @@
 /// - Rings are preserved exactly as stored by QGIS:
 ///   part 0 is outer, remaining parts are holes.
 /// - No polygon correction, closure, or validation is performed.
+///
+/// Writing produces that schema for the boundaries and a polyline set for
+/// the swaths, both built in memory through the same hooks.
+///
+/// shapelib checks the headers and reads the DBF; polygon records are
+/// decoded straight from the .shp bytes into the FarmDb's arena, skipping
+/// the per-record SHPObject and its coordinate arrays.
 
-#include "FarmDb.hpp"
+#include "FarmShp.hpp"
+#include "MappedFile.hpp"
+#include "parallel.hpp"
 
 #include <boost/geometry/algorithms/correct.hpp>
 
 #include <shapefil.h>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
 #include <filesystem>
+#include <fstream>
 #include <memory>
+#include <new>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace farm_db {
 
@@ -43,16 +68,18 @@ namespace fs = std::filesystem;
   throw std::runtime_error{oss.str()};
 } // ThrowShpError
 
+// Names are interned once: keys view the names owned by the Customer,
+// Farm or Field they map to, and a farm or field is keyed on its parent
+// rather than on the parent's name again.
 struct FarmKey {
-  std::string client;
-  std::string farm;
+  const Customer* customer;
+  std::string_view farm;
   bool operator==(const FarmKey&) const = default;
 }; // FarmKey
 
 struct FieldKey {
-  std::string client;
-  std::string farm;
-  std::string field;
+  const Farm* farm;
+  std::string_view field;
   bool operator==(const FieldKey&) const = default;
 }; // FieldKey
 
@@ -66,26 +93,24 @@ template<typename T1, typename T2>
 constexpr std::size_t Hash(const T1& x1, const T2& x2) noexcept
   { return HashCombine(Hash(x1), Hash(x2)); }
 
-template<typename T1, typename T2, typename T3>
-constexpr std::size_t Hash(const T1& x1, const T2& x2, const T3& x3) noexcept
-  { return HashCombine(HashCombine(Hash(x1), Hash(x2)), Hash(x3)); }
-
 struct FarmKeyHash {
   std::size_t operator()(const FarmKey& k) const noexcept
-    { return Hash(k.client, k.farm); }
+    { return Hash(k.customer, k.farm); }
 }; // FarmKeyHash
 
 struct FieldKeyHash {
   std::size_t operator()(const FieldKey& k) const noexcept
-    { return Hash(k.client, k.farm, k.field); }
+    { return Hash(k.farm, k.field); }
 }; // FieldKeyHash
 
-[[nodiscard]]
-std::string RequireDbfString(const fs::path& shpPath,
-                             DBFHandle hDbf,
-                             int recordIndex0,
-                             int fieldIndex,
-                             const char* fieldName)
+// Copies into `out`, which is reused from record to record: shapelib's
+// buffer is overwritten by the next read.
+void RequireDbfString(const fs::path& shpPath,
+                      DBFHandle hDbf,
+                      int recordIndex0,
+                      int fieldIndex,
+                      const char* fieldName,
+                      std::string& out)
 {
   const auto* s = DBFReadStringAttribute(hDbf, recordIndex0, fieldIndex);
   if (!s || s[0] == '\0') {
@@ -93,7 +118,7 @@ std::string RequireDbfString(const fs::path& shpPath,
     oss << "missing or empty DBF field '" << fieldName << "'";
     ThrowShpError(shpPath, recordIndex0, oss.str());
   }
-  return std::string{s};
+  out.assign(s);
 } // RequireDbfString
 
 void RequireDbfSchemaExact(const fs::path& shpPath, DBFHandle hDbf) {
@@ -130,67 +155,371 @@ void RequireDbfSchemaExact(const fs::path& shpPath, DBFHandle hDbf) {
   }
 } // RequireDbfSchemaExact
 
-void AppendRingLiteral(Polygon& poly, int ringIndex,
-                       const double* xs, const double* ys,
-                       int start, int end)
-{
+std::uint32_t LoadU32(const std::byte* p, std::endian order) noexcept {
+  auto x = std::uint32_t{};
+  std::memcpy(&x, p, sizeof(x));
+  return (order == std::endian::native) ? x : std::byteswap(x);
+} // LoadU32
+
+double LoadF64(const std::byte* p) noexcept {
+  auto x = std::uint64_t{};
+  std::memcpy(&x, p, sizeof(x));
+  if constexpr (std::endian::native != std::endian::little)
+    x = std::byteswap(x);
+  return std::bit_cast<double>(x);
+} // LoadF64
+
+// The polygon records of a .shp file.  Record headers are big-endian,
+// their contents little-endian.  Each record is found through its .shx
+// entry, as shapelib finds it, since the format lets records sit in any
+// order with gaps between them; the entries are indexed up front, so any
+// record can then be decoded on any thread.
+class ShpRecords {
+  static constexpr std::size_t FileHeader   = 100;
+  static constexpr std::size_t RecordHeader =   8;
+  static constexpr std::size_t PolyHeader   =  44; // type, box, counts
+
+  struct Rec {
+    std::size_t content;
+    std::size_t len;
+  }; // Rec
+
+  const fs::path& _path;
+  std::span<const std::byte> _bytes;
+  std::vector<Rec> _recs;
+  std::exception_ptr _indexError; // for record _recs.size(), if any
+
+  std::int32_t i32(std::size_t at) const noexcept {
+    return static_cast<std::int32_t>(
+                        LoadU32(_bytes.data() + at, std::endian::little));
+  } // i32
+
+public:
+  // A bad record header is not reported here but when its record is read,
+  // after every record before it, as reading strictly in order would.
+  ShpRecords(const fs::path& path, std::span<const std::byte> bytes,
+             std::span<const std::byte> shx, int nEntities)
+    : _path{path}, _bytes{bytes}
+  {
+    if (_bytes.size() < FileHeader)
+      ThrowShpError(_path, "truncated .shp header");
+    const auto n = static_cast<std::size_t>(nEntities);
+    if (shx.size() < FileHeader || (shx.size() - FileHeader) / 8 < n)
+      ThrowShpError(_path, "truncated .shx file");
+    _recs.reserve(n);
+    try {
+      for (int i = 0; i != nEntities; ++i) {
+        const auto* entry = shx.data() + FileHeader + 8 * std::size_t(i);
+        const auto pos = std::size_t{LoadU32(entry, std::endian::big)} * 2;
+        const auto len = std::size_t{LoadU32(entry + 4, std::endian::big)}
+                       * 2;
+        if (pos < FileHeader || pos > _bytes.size()
+            || _bytes.size() - pos < RecordHeader)
+          ThrowShpError(_path, i, "truncated record header");
+        const auto number = LoadU32(_bytes.data() + pos, std::endian::big);
+        if (number != static_cast<std::uint32_t>(i) + 1)
+          ThrowShpError(_path, i, "record number does not match the .shx");
+        const auto content = pos + RecordHeader;
+        if (_bytes.size() - content < len)
+          ThrowShpError(_path, i, "truncated record");
+        _recs.push_back(Rec{content, len});
+      }
+    } catch (const std::runtime_error&) {
+      _indexError = std::current_exception();
+    }
+  } // ctor
+
   // Literal preservation:
   // - do not force closure
   // - do not reorder points
   // - do not validate or correct
-  auto& ring = (ringIndex == 0) ? poly.outer() : poly.inners().emplace_back();
-
-  ring.reserve(static_cast<std::size_t>(end - start));
-
-  using mp_units::si::unit_symbols::deg;
-  for (int i = start; i != end; ++i) {
-    const auto lon = xs[i];
-    const auto lat = ys[i];
-    ring.emplace_back(lat * deg, lon * deg);
-  }
-} // AppendRingLiteral
-
-} // local
-
-FarmDb FarmDb::ReadShp(const fs::path& path) {
-  if (path.extension() != ".shp") ThrowShpError(path, "expected a .shp file");
-
-  const auto shpPath = path;
-  const auto shxPath = fs::path{path}.replace_extension(".shx");
-  const auto dbfPath = fs::path{path}.replace_extension(".dbf");
-
-  if (!fs::exists(shpPath)) ThrowShpError(shpPath, "file does not exist");
-  if (!fs::exists(shxPath))
-    ThrowShpError(shpPath, "missing required sibling .shx file");
-  if (!fs::exists(dbfPath))
-    ThrowShpError(shpPath, "missing required sibling .dbf file");
-
-  // Shapelib classic API uses narrow paths.
-  const auto shpPathStr = shpPath.string();
-  const auto dbfPathStr = dbfPath.string();
-
-  SHPHandle hShp = SHPOpen(shpPathStr.c_str(), "rb");
-  if (!hShp) ThrowShpError(shpPath, "SHPOpen failed");
-
-  struct ShpCloser {
-    void operator()(SHPHandle h) const noexcept { if (h) SHPClose(h); }
-  }; // ShpCloser
-  using UniqShpPtr =
-                  std::unique_ptr<std::remove_pointer_t<SHPHandle>, ShpCloser>;
-
-  const auto shpGuard = UniqShpPtr{hShp};
-
-  DBFHandle hDbf = DBFOpen(dbfPathStr.c_str(), "rb");
-  if (!hDbf) ThrowShpError(shpPath, "DBFOpen failed");
-
-  struct DbfCloser {
-    void operator()(DBFHandle h) const noexcept { if (h) DBFClose(h); }
-  }; // DbfCloser
-  using UniqDbfPtr =
-                  std::unique_ptr<std::remove_pointer_t<DBFHandle>, DbfCloser>;
-
-  const auto dbfGuard = UniqDbfPtr{hDbf};
+  void read(int i, Polygon& poly) const {
+    if (static_cast<std::size_t>(i) >= _recs.size())
+      std::rethrow_exception(_indexError);
+    const auto [content, len] = _recs[static_cast<std::size_t>(i)];
+
+    if (len < 4 || i32(content) == SHPT_NULL)
+      ThrowShpError(_path, i, "polygon has no parts/rings");
+    if (i32(content) != SHPT_POLYGON)
+      ThrowShpError(_path, i, "record is not a polygon");
+    if (len < PolyHeader)
+      ThrowShpError(_path, i, "truncated polygon record");
+    const auto nParts    = i32(content + 36);
+    const auto nVertices = i32(content + 40);
+    if (nParts <= 0)
+      ThrowShpError(_path, i, "polygon has no parts/rings");
+    if (nVertices <= 0)
+      ThrowShpError(_path, i, "polygon has no vertices");
+    const auto parts  = content + PolyHeader;
+    const auto points = parts + 4 * std::size_t(nParts);
+    if (PolyHeader + 4 * std::size_t(nParts) + 16 * std::size_t(nVertices)
+        > len)
+      ThrowShpError(_path, i, "polygon record shorter than its counts");
+
+    using mp_units::si::unit_symbols::deg;
+    for (int part = 0; part != nParts; ++part) {
+      const auto start = i32(parts + 4 * std::size_t(part));
+      const auto end   = (part + 1 < nParts)
+                       ? i32(parts + 4 * std::size_t(part + 1)) : nVertices;
+      if (start < 0 || end < 0 || start >= end || end > nVertices)
+        ThrowShpError(_path, i, "invalid part vertex range");
+
+      auto& ring = (part == 0) ? poly.outer() : poly.inners().emplace_back();
+      ring.reserve(static_cast<std::size_t>(end - start));
+      const auto* p = _bytes.data() + points + 16 * std::size_t(start);
+      for (int k = start; k != end; ++k, p += 16) {
+        const auto lon = LoadF64(p);
+        const auto lat = LoadF64(p + 8);
+        ring.emplace_back(lat * deg, lon * deg);
+      }
+    }
+  } // read
 
+  // Read and corrected, as every record is before it is added to a field.
+  Polygon decode(int i) const {
+    auto poly = Polygon{};
+    read(i, poly);
+    boost::geometry::correct(poly);
+    return poly;
+  } // decode
+}; // ShpRecords
+
+// Every polygon decoded and corrected up front, in chunks on several
+// threads, each chunk into its own child of the FarmDb's arena.  A chunk
+// stops at its first bad record and keeps the error for the merge, which
+// rethrows it on reaching that record, so errors surface in file order.
+class ShpDecoded {
+  struct Chunk {
+    int begin;
+    int end;
+    int bad = -1;
+    std::exception_ptr error;
+  }; // Chunk
+
+  std::vector<Polygon> _polys;
+  std::vector<Chunk>   _chunks;
+  int _chunkSize = 1;
+
+public:
+  ShpDecoded(const ShpRecords& records, int nEntities, tjg::Arena& arena,
+             int threads)
+    : _polys(static_cast<std::size_t>(nEntities))
+  {
+    // A few chunks per thread evens out uneven record sizes.
+    const auto nChunks = std::min(nEntities, 4 * tjg::ThreadCount(threads));
+    _chunkSize = (nEntities + nChunks - 1) / nChunks;
+    auto arenas = std::vector<tjg::Arena*>{};
+    for (auto b = 0; b < nEntities; b += _chunkSize) {
+      const auto e = std::min(b + _chunkSize, nEntities);
+      _chunks.push_back(Chunk{b, e, -1, {}});
+      arenas.push_back(&arena.child());
+    }
+    tjg::ParallelFor(_chunks.size(), threads, [&](std::size_t c) {
+      auto& chunk = _chunks[c];
+      auto scope = tjg::ArenaScope{*arenas[c]};
+      for (auto i = chunk.begin; i != chunk.end; ++i) {
+        try {
+          _polys[static_cast<std::size_t>(i)] = records.decode(i);
+        } catch (const std::runtime_error&) {
+          chunk.bad   = i;
+          chunk.error = std::current_exception();
+          return;
+        }
+      }
+    });
+  } // ctor
+
+  Polygon take(int i) {
+    const auto& chunk = _chunks[static_cast<std::size_t>(i / _chunkSize)];
+    if (i == chunk.bad)
+      std::rethrow_exception(chunk.error);
+    return std::move(_polys[static_cast<std::size_t>(i)]);
+  } // take
+}; // ShpDecoded
+
+struct ShpCloser {
+  void operator()(SHPHandle h) const noexcept { if (h) SHPClose(h); }
+}; // ShpCloser
+using UniqShpPtr = std::unique_ptr<std::remove_pointer_t<SHPHandle>, ShpCloser>;
+
+struct DbfCloser {
+  void operator()(DBFHandle h) const noexcept { if (h) DBFClose(h); }
+}; // DbfCloser
+using UniqDbfPtr = std::unique_ptr<std::remove_pointer_t<DBFHandle>, DbfCloser>;
+
+// Read-only shapelib file hooks over the buffers of a ShpBuffers.  The file
+// to open is chosen by its extension, so the base name shapelib derives
+// from ShpBuffers::path does not matter.
+namespace mem {
+
+struct File {
+  const std::vector<char>* data;
+  std::size_t pos = 0;
+}; // File
+
+File* Get(SAFile fp) noexcept { return reinterpret_cast<File*>(fp); }
+
+SAFile Open(const char* filename, const char* access, void* user) {
+  if (std::string_view{access}.find_first_of("wa+") != std::string_view::npos)
+    return nullptr;
+  const auto& files = *static_cast<const ShpBuffers*>(user);
+  auto ext = fs::path{filename}.extension().string();
+  std::ranges::transform(ext, ext.begin(),
+      [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  const std::vector<char>* data = nullptr;
+  if      (ext == ".shp") data = &files.shp;
+  else if (ext == ".shx") data = &files.shx;
+  else if (ext == ".dbf") data = &files.dbf;
+  else if (ext == ".cpg") data = &files.cpg;
+  if (!data || data->empty())
+    return nullptr;
+  return reinterpret_cast<SAFile>(new (std::nothrow) File{data});
+} // Open
+
+SAOffset Read(void* p, SAOffset size, SAOffset nmemb, SAFile fp) {
+  auto& f = *Get(fp);
+  if (size == 0)
+    return 0;
+  const auto n = std::min<std::size_t>(nmemb, (f.data->size() - f.pos) / size);
+  std::memcpy(p, f.data->data() + f.pos, n * size);
+  f.pos += n * size;
+  return static_cast<SAOffset>(n);
+} // Read
+
+SAOffset Write(const void*, SAOffset, SAOffset, SAFile) { return 0; }
+
+SAOffset Seek(SAFile fp, SAOffset offset, int whence) {
+  auto& f = *Get(fp);
+  auto base = std::size_t{0};
+  if (whence == SEEK_CUR)
+    base = f.pos;
+  else if (whence == SEEK_END)
+    base = f.data->size();
+  else if (whence != SEEK_SET)
+    return static_cast<SAOffset>(-1);
+  if (offset > f.data->size() - base)
+    return static_cast<SAOffset>(-1);
+  f.pos = base + offset;
+  return 0;
+} // Seek
+
+SAOffset Tell(SAFile fp) { return static_cast<SAOffset>(Get(fp)->pos); }
+
+int Flush(SAFile) { return 0; }
+
+int Close(SAFile fp) {
+  delete Get(fp);
+  return 0;
+} // Close
+
+int Remove(const char*, void*) { return -1; }
+
+SAHooks Hooks(const ShpBuffers& files) {
+  auto hooks = SAHooks{};
+  SASetupDefaultHooks(&hooks);
+  hooks.FOpen  = Open;
+  hooks.FRead  = Read;
+  hooks.FWrite = Write;
+  hooks.FSeek  = Seek;
+  hooks.FTell  = Tell;
+  hooks.FFlush = Flush;
+  hooks.FClose = Close;
+  hooks.Remove = Remove;
+  hooks.pvUserData = const_cast<ShpBuffers*>(&files);
+  return hooks;
+} // Hooks
+
+// Writable files over the buffers of a ShpBuffers being built.  shapelib
+// creates each file, then reopens the .shp and .shx "r+b" to finish them.
+struct Sink {
+  std::vector<char>* data;
+  std::size_t pos = 0;
+}; // Sink
+
+Sink* GetSink(SAFile fp) noexcept { return reinterpret_cast<Sink*>(fp); }
+
+SAFile OpenW(const char* filename, const char* access, void* user) {
+  auto& files = *static_cast<ShpBuffers*>(user);
+  auto ext = fs::path{filename}.extension().string();
+  std::ranges::transform(ext, ext.begin(),
+      [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  std::vector<char>* data = nullptr;
+  if      (ext == ".shp") data = &files.shp;
+  else if (ext == ".shx") data = &files.shx;
+  else if (ext == ".dbf") data = &files.dbf;
+  else if (ext == ".cpg") data = &files.cpg;
+  if (!data)
+    return nullptr;
+  if (std::string_view{access}.find('w') != std::string_view::npos)
+    data->clear();
+  return reinterpret_cast<SAFile>(new (std::nothrow) Sink{data});
+} // OpenW
+
+SAOffset ReadW(void* p, SAOffset size, SAOffset nmemb, SAFile fp) {
+  auto& f = *GetSink(fp);
+  if (size == 0)
+    return 0;
+  const auto n = std::min<std::size_t>(nmemb, (f.data->size() - f.pos) / size);
+  std::memcpy(p, f.data->data() + f.pos, n * size);
+  f.pos += n * size;
+  return static_cast<SAOffset>(n);
+} // ReadW
+
+SAOffset WriteW(const void* p, SAOffset size, SAOffset nmemb, SAFile fp) {
+  auto& f = *GetSink(fp);
+  const auto n = std::size_t{size} * nmemb;
+  if (f.pos + n > f.data->size())
+    f.data->resize(f.pos + n);
+  std::memcpy(f.data->data() + f.pos, p, n);
+  f.pos += n;
+  return nmemb;
+} // WriteW
+
+SAOffset SeekW(SAFile fp, SAOffset offset, int whence) {
+  auto& f = *GetSink(fp);
+  auto base = std::size_t{0};
+  if (whence == SEEK_CUR)
+    base = f.pos;
+  else if (whence == SEEK_END)
+    base = f.data->size();
+  else if (whence != SEEK_SET)
+    return static_cast<SAOffset>(-1);
+  f.pos = base + offset; // a later write fills any gap
+  return 0;
+} // SeekW
+
+SAOffset TellW(SAFile fp) { return static_cast<SAOffset>(GetSink(fp)->pos); }
+
+int CloseW(SAFile fp) {
+  delete GetSink(fp);
+  return 0;
+} // CloseW
+
+int RemoveW(const char*, void*) { return 0; }
+
+SAHooks WriteHooks(ShpBuffers& files) {
+  auto hooks = SAHooks{};
+  SASetupDefaultHooks(&hooks);
+  hooks.FOpen  = OpenW;
+  hooks.FRead  = ReadW;
+  hooks.FWrite = WriteW;
+  hooks.FSeek  = SeekW;
+  hooks.FTell  = TellW;
+  hooks.FFlush = Flush;
+  hooks.FClose = CloseW;
+  hooks.Remove = RemoveW;
+  hooks.pvUserData = &files;
+  return hooks;
+} // WriteHooks
+
+} // mem
+
+// Customers, farms and fields are linked in record order on this thread;
+// with several threads the geometry is decoded beforehand.
+FarmDb ReadShpHandles(const fs::path& shpPath, SHPHandle hShp,
+                      DBFHandle hDbf, std::span<const std::byte> shpBytes,
+                      std::span<const std::byte> shxBytes, int threads)
+{
   RequireDbfSchemaExact(shpPath, hDbf);
 
   int shapeType = 0;
@@ -214,15 +543,27 @@ FarmDb FarmDb::ReadShp(const fs::path& path) {
   }
 
   auto db = FarmDb{};
-
-  std::unordered_map<std::string, Customer*> customersByName;
+  auto arena = tjg::ArenaScope{*db.arena};
+  const auto records = ShpRecords{shpPath, shpBytes, shxBytes, nEntities};
+  auto decoded = std::optional<ShpDecoded>{};
+  if (tjg::ThreadCount(threads) > 1 && nEntities > 1)
+    decoded.emplace(records, nEntities, *db.arena, threads);
+
+  // Every record may be a new field; customers and farms are far fewer.
+  const auto n = static_cast<std::size_t>(nEntities);
+  db.fields.reserve(n);
+  std::unordered_map<std::string_view, Customer*> customersByName;
   std::unordered_map<FarmKey,   Farm*, FarmKeyHash > farmsByKey;
   std::unordered_map<FieldKey, Field*, FieldKeyHash> fieldsByKey;
+  fieldsByKey.reserve(n);
 
+  auto clientName = std::string{};
+  auto farmName   = std::string{};
+  auto fieldName  = std::string{};
   for (int i = 0; i < nEntities; ++i) {
-    const auto clientName = RequireDbfString(shpPath, hDbf, i, 1, "CLIENTNAME");
-    const auto farmName   = RequireDbfString(shpPath, hDbf, i, 2, "FARM_NAME");
-    const auto fieldName  = RequireDbfString(shpPath, hDbf, i, 3, "FIELD_NAME");
+    RequireDbfString(shpPath, hDbf, i, 1, "CLIENTNAME", clientName);
+    RequireDbfString(shpPath, hDbf, i, 2, "FARM_NAME",  farmName);
+    RequireDbfString(shpPath, hDbf, i, 3, "FIELD_NAME", fieldName);
 
     Customer* customer = nullptr;
     {
@@ -238,8 +579,7 @@ FarmDb FarmDb::ReadShp(const fs::path& path) {
 
     Farm* farm = nullptr;
     {
-      FarmKey k{clientName, farmName};
-      auto it = farmsByKey.find(k);
+      auto it = farmsByKey.find(FarmKey{customer, farmName});
       if (it != farmsByKey.end()) {
         farm = it->second;
       } else {
@@ -247,7 +587,7 @@ FarmDb FarmDb::ReadShp(const fs::path& path) {
         farm = db.farms.back().get();
         farm->customer = customer;
         customer->farms.push_back(farm);
-        farmsByKey.emplace(std::move(k), farm);
+        farmsByKey.emplace(FarmKey{customer, farm->name}, farm);
       }
 
       if (farm->customer != customer)
@@ -256,8 +596,7 @@ FarmDb FarmDb::ReadShp(const fs::path& path) {
 
     Field* field = nullptr;
     {
-      FieldKey k{clientName, farmName, fieldName};
-      auto it = fieldsByKey.find(k);
+      auto it = fieldsByKey.find(FieldKey{farm, fieldName});
       if (it != fieldsByKey.end()) {
         field = it->second;
       } else {
@@ -266,7 +605,7 @@ FarmDb FarmDb::ReadShp(const fs::path& path) {
         field->customer = customer;
         field->farm = farm;
         farm->fields.push_back(field);
-        fieldsByKey.emplace(std::move(k), field);
+        fieldsByKey.emplace(FieldKey{farm, field->name}, field);
       }
 
       if (field->farm != farm)
@@ -282,42 +621,260 @@ FarmDb FarmDb::ReadShp(const fs::path& path) {
       }
     }
 
-    auto obj = SHPReadObject(hShp, i);
-    if (!obj) ThrowShpError(shpPath, i, "SHPReadObject failed");
+    field->parts.push_back(decoded ? decoded->take(i) : records.decode(i));
+  }
+
+  return db;
+} // ReadShpHandles
+
+// ---------------------------------------------------------------------
+// Writing
+
+constexpr int DbfMaxWidth = 254;
+
+struct Names {
+  std::string_view client;
+  std::string_view farm;
+  std::string_view field;
+}; // Names
+
+// Fields without a customer or farm get empty names, which ReadShp
+// rejects: such fields do not round trip.
+Names NamesOf(const Field& field) noexcept {
+  return {field.customer ? std::string_view{field.customer->name} : "",
+          field.farm     ? std::string_view{field.farm->name}     : "",
+          field.name};
+} // NamesOf
+
+int DbfWidth(const fs::path& path, const char* column, std::size_t width) {
+  if (width > DbfMaxWidth)
+    ThrowShpError(path, std::string{"name too long for DBF field "} + column);
+  return std::max(1, static_cast<int>(width));
+} // DbfWidth
+
+// One shapefile set built in memory.  The columns are fid and the three
+// names, then `lastColumn`; records are added in order.
+class ShpBuilder {
+  ShpBuffers _files;
+  SAHooks    _hooks;
+  UniqShpPtr _shp;
+  UniqDbfPtr _dbf;
+  int _record = 0;
+  std::vector<double> _xs;
+  std::vector<double> _ys;
+  std::vector<int>    _starts;
+
+  void addColumn(const char* name, DBFFieldType type, int width) {
+    if (DBFAddField(_dbf.get(), name, type, width, 0) < 0)
+      ThrowShpError(_files.path, std::string{"cannot add DBF field "} + name);
+  } // addColumn
+
+public:
+  // `widths` are the widest client, farm, field and last-column strings;
+  // a last column of width 0 is the integer WITH_HOLES.
+  ShpBuilder(const fs::path& path, int shapeType, const char* lastColumn,
+             const std::array<std::size_t, 4>& widths)
+    : _files{path, {}, {}, {}, {}}, _hooks{mem::WriteHooks(_files)}
+  {
+    const auto pathStr = path.string();
+    _shp.reset(SHPCreateLL(pathStr.c_str(), shapeType, &_hooks));
+    if (!_shp) ThrowShpError(path, "SHPCreate failed");
+    _dbf.reset(DBFCreateLL(pathStr.c_str(), "UTF-8", &_hooks));
+    if (!_dbf) ThrowShpError(path, "DBFCreate failed");
+    addColumn("fid", FTInteger, 10);
+    addColumn("CLIENTNAME", FTString, DbfWidth(path, "CLIENTNAME", widths[0]));
+    addColumn("FARM_NAME",  FTString, DbfWidth(path, "FARM_NAME",  widths[1]));
+    addColumn("FIELD_NAME", FTString, DbfWidth(path, "FIELD_NAME", widths[2]));
+    if (widths[3] == 0)
+      addColumn(lastColumn, FTInteger, 1);
+    else
+      addColumn(lastColumn, FTString, DbfWidth(path, lastColumn, widths[3]));
+  } // ctor
+
+  ShpBuilder(const ShpBuilder&) = delete;
+  ShpBuilder& operator=(const ShpBuilder&) = delete;
+
+  // Starts a shape; then add() each part.
+  void clear() {
+    _xs.clear();
+    _ys.clear();
+    _starts.clear();
+  } // clear
+
+  template<class Pts>
+  void add(const Pts& pts) {
+    _starts.push_back(static_cast<int>(_xs.size()));
+    for (const auto& p: pts) {
+      _xs.push_back(boost::geometry::get<0>(p));
+      _ys.push_back(boost::geometry::get<1>(p));
+    }
+  } // add
 
+  // Writes the shape built since clear() with its attributes.
+  template<class Last>
+  void write(int shapeType, const Names& names, const Last& last) {
     struct ObjDestroy {
       void operator()(SHPObject* p) const noexcept
         { if (p) SHPDestroyObject(p); }
     }; // ObjDestroy
-    using UniqObjPtr = std::unique_ptr<SHPObject, ObjDestroy>;
+    const auto obj = std::unique_ptr<SHPObject, ObjDestroy>{SHPCreateObject(
+        shapeType, -1, static_cast<int>(_starts.size()), _starts.data(),
+        nullptr, static_cast<int>(_xs.size()), _xs.data(), _ys.data(),
+        nullptr, nullptr)};
+    if (!obj || SHPWriteObject(_shp.get(), -1, obj.get()) < 0)
+      ThrowShpError(_files.path, _record, "cannot write shape");
+    const auto clientName = std::string{names.client};
+    const auto farmName   = std::string{names.farm};
+    const auto fieldName  = std::string{names.field};
+    auto* dbf = _dbf.get();
+    auto ok = DBFWriteIntegerAttribute(dbf, _record, 0, _record + 1)
+           && DBFWriteStringAttribute(dbf, _record, 1, clientName.c_str())
+           && DBFWriteStringAttribute(dbf, _record, 2, farmName.c_str())
+           && DBFWriteStringAttribute(dbf, _record, 3, fieldName.c_str());
+    if constexpr (std::is_same_v<Last, int>)
+      ok = ok && DBFWriteIntegerAttribute(dbf, _record, 4, last);
+    else
+      ok = ok && DBFWriteStringAttribute(dbf, _record, 4, last.c_str());
+    if (!ok)
+      ThrowShpError(_files.path, _record, "cannot write DBF record");
+    ++_record;
+  } // write
+
+  // Closes the set, which writes the headers, and hands over its files.
+  ShpBuffers finish() {
+    _shp.reset();
+    _dbf.reset();
+    return std::move(_files);
+  } // finish
+}; // ShpBuilder
+
+void WriteFile(const fs::path& path, const std::vector<char>& data) {
+  auto os = std::ofstream{path, std::ios::binary};
+  if (os)
+    os.write(data.data(), static_cast<std::streamsize>(data.size()));
+  if (os)
+    os.close();
+  if (!os)
+    ThrowShpError(path, "error writing file");
+} // WriteFile
 
-    const auto objGuard = UniqObjPtr{obj};
+} // local
 
-    if (obj->nParts <= 0)
-      ThrowShpError(shpPath, i, "polygon has no parts/rings");
+ShpBuffers BoundaryShp(const FarmDb& db, const fs::path& path) {
+  auto widths = std::array<std::size_t, 4>{};
+  for (const auto& field: db.fields) {
+    const auto names = NamesOf(*field);
+    widths[0] = std::max(widths[0], names.client.size());
+    widths[1] = std::max(widths[1], names.farm.size());
+    widths[2] = std::max(widths[2], names.field.size());
+  }
+  auto shp = ShpBuilder{path, SHPT_POLYGON, "WITH_HOLES", widths};
+  for (const auto& field: db.fields) {
+    const auto names = NamesOf(*field);
+    for (const auto& part: field->parts) {
+      shp.clear();
+      shp.add(part.outer());
+      for (const auto& inner: part.inners())
+        shp.add(inner);
+      shp.write(SHPT_POLYGON, names, part.inners().empty() ? 0 : 1);
+    }
+  }
+  return shp.finish();
+} // BoundaryShp
+
+ShpBuffers SwathShp(const FarmDb& db, const fs::path& path) {
+  auto widths = std::array<std::size_t, 4>{0, 0, 0, 1};
+  for (const auto& field: db.fields) {
+    const auto names = NamesOf(*field);
+    widths[0] = std::max(widths[0], names.client.size());
+    widths[1] = std::max(widths[1], names.farm.size());
+    widths[2] = std::max(widths[2], names.field.size());
+    for (const auto& swath: field->swaths)
+      widths[3] = std::max(widths[3], swath.name.size());
+  }
+  auto shp = ShpBuilder{path, SHPT_ARC, "SWATH_NAME", widths};
+  for (const auto& field: db.fields) {
+    const auto names = NamesOf(*field);
+    for (const auto& swath: field->swaths) {
+      if (swath.path.size() < 2)
+        continue;
+      shp.clear();
+      shp.add(swath.path);
+      shp.write(SHPT_ARC, names, swath.name);
+    }
+  }
+  return shp.finish();
+} // SwathShp
+
+fs::path SwathShpPath(const fs::path& shpPath) {
+  auto stem = shpPath.stem();
+  stem += "_swaths.shp";
+  return fs::path{shpPath}.replace_filename(stem);
+} // SwathShpPath
+
+void FarmDb::writeShp(const fs::path& output) const {
+  if (output.extension() != ".shp")
+    ThrowShpError(output, "FarmDb::writeShp: expected a .shp file");
+  for (const auto& files: {BoundaryShp(*this, output),
+                           SwathShp(*this, SwathShpPath(output))})
+  {
+    auto path = files.path;
+    WriteFile(path, files.shp);
+    WriteFile(path.replace_extension(".shx"), files.shx);
+    WriteFile(path.replace_extension(".dbf"), files.dbf);
+    if (!files.cpg.empty())
+      WriteFile(path.replace_extension(".cpg"), files.cpg);
+  }
+} // FarmDb::writeShp
 
-    if (obj->nVertices <= 0)
-      ThrowShpError(shpPath, i, "polygon has no vertices");
+FarmDb FarmDb::ReadShp(const fs::path& path, int threads) {
+  if (path.extension() != ".shp") ThrowShpError(path, "expected a .shp file");
 
-    auto poly = Polygon{};
+  const auto shpPath = path;
+  const auto shxPath = fs::path{path}.replace_extension(".shx");
+  const auto dbfPath = fs::path{path}.replace_extension(".dbf");
 
-    for (int part = 0; part != obj->nParts; ++part) {
-      const auto start = obj->panPartStart[part];
-      const auto end = (part + 1) < obj->nParts
-                     ? obj->panPartStart[part + 1]
-                     : obj->nVertices;
+  if (!fs::exists(shpPath)) ThrowShpError(shpPath, "file does not exist");
+  if (!fs::exists(shxPath))
+    ThrowShpError(shpPath, "missing required sibling .shx file");
+  if (!fs::exists(dbfPath))
+    ThrowShpError(shpPath, "missing required sibling .dbf file");
 
-      if (start < 0 || end < 0 || start >= end || end > obj->nVertices)
-        ThrowShpError(shpPath, i, "invalid part vertex range");
+  // Shapelib classic API uses narrow paths.
+  const auto shpPathStr = shpPath.string();
+  const auto dbfPathStr = dbfPath.string();
 
-      AppendRingLiteral(poly, part, obj->padfX, obj->padfY, start, end);
-    }
+  const auto shpGuard = UniqShpPtr{SHPOpen(shpPathStr.c_str(), "rb")};
+  if (!shpGuard) ThrowShpError(shpPath, "SHPOpen failed");
 
-    boost::geometry::correct(poly);
-    field->parts.push_back(std::move(poly));
-  }
+  const auto dbfGuard = UniqDbfPtr{DBFOpen(dbfPathStr.c_str(), "rb")};
+  if (!dbfGuard) ThrowShpError(shpPath, "DBFOpen failed");
 
-  return db;
+  const auto shpFile = tjg::MappedFile{shpPath};
+  const auto shxFile = tjg::MappedFile{shxPath};
+  return ReadShpHandles(shpPath, shpGuard.get(), dbfGuard.get(),
+                        shpFile.bytes(), shxFile.bytes(), threads);
 } // FarmDb::ReadShp
 
+FarmDb ReadShp(const ShpBuffers& files, int threads) {
+  const auto& shpPath = files.path;
+  if (files.shx.empty())
+    ThrowShpError(shpPath, "missing required sibling .shx file");
+  if (files.dbf.empty())
+    ThrowShpError(shpPath, "missing required sibling .dbf file");
+
+  const auto hooks   = mem::Hooks(files);
+  const auto pathStr = shpPath.string();
+
+  const auto shpGuard = UniqShpPtr{SHPOpenLL(pathStr.c_str(), "rb", &hooks)};
+  if (!shpGuard) ThrowShpError(shpPath, "SHPOpen failed");
+
+  const auto dbfGuard = UniqDbfPtr{DBFOpenLL(pathStr.c_str(), "rb", &hooks)};
+  if (!dbfGuard) ThrowShpError(shpPath, "DBFOpen failed");
+
+  return ReadShpHandles(shpPath, shpGuard.get(), dbfGuard.get(),
+                        std::as_bytes(std::span{files.shp}),
+                        std::as_bytes(std::span{files.shx}), threads);
+} // ReadShp(ShpBuffers)
+
 } // farm_db
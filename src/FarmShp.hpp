@@ -0,0 +1,38 @@
+/// @file
+/// Reads a shapefile set held in memory, e.g. decompressed from a zip.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+#pragma once
+#include "FarmDb.hpp"
+
+#include <filesystem>
+#include <vector>
+
+namespace farm_db {
+
+/// The files of one shapefile set.  `path` names the .shp in messages;
+/// `cpg` may be empty.
+struct ShpBuffers {
+  std::filesystem::path path;
+  std::vector<char> shp;
+  std::vector<char> shx;
+  std::vector<char> dbf;
+  std::vector<char> cpg;
+}; // ShpBuffers
+
+/// Same checks and result as FarmDb::ReadShp, without touching the disk.
+FarmDb ReadShp(const ShpBuffers& files, int threads = 1);
+
+/// Every field part as a polygon record with the schema ReadShp expects:
+/// fid, CLIENTNAME, FARM_NAME, FIELD_NAME, WITH_HOLES.
+ShpBuffers BoundaryShp(const FarmDb& db, const std::filesystem::path& path);
+
+/// Every swath of two or more points as a polyline record: fid,
+/// CLIENTNAME, FARM_NAME, FIELD_NAME, SWATH_NAME.
+ShpBuffers SwathShp(const FarmDb& db, const std::filesystem::path& path);
+
+/// Where the swaths go beside boundaries written to `shpPath`:
+/// "<stem>_swaths.shp".
+std::filesystem::path SwathShpPath(const std::filesystem::path& shpPath);
+
+} // farm_db
@@ -0,0 +1,41 @@
+/// @file
+/// Produces the FarmDb::writeWkt text a piece at a time.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+#pragma once
+#include "FarmDb.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace farm_db {
+
+/// Each piece is one chunk of consecutive fields; a round of chunks is
+/// formatted in parallel when the previous round has been taken.
+class WktWriter {
+  const FarmDb& _db;
+  WktOptions _options;
+  int _threads;
+  std::vector<std::size_t> _bounds;  // chunk c is fields [_bounds[c], [c+1])
+  std::vector<std::string> _bufs;    // the current round
+  std::size_t _nextChunk = 0;        // first chunk of the next round
+  std::size_t _piece = 0;            // next piece of the current round
+  std::size_t _numPieces = 0;
+  std::string_view _rest;            // what read() has not taken of a piece
+
+public:
+  WktWriter(const FarmDb& db, const WktOptions& options);
+
+  WktWriter(const WktWriter&) = delete;
+  WktWriter& operator=(const WktWriter&) = delete;
+
+  /// The next piece; empty at the end.  Valid until the next call.
+  std::string_view next();
+
+  /// Copies up to `size` bytes into `buf`; returns 0 at the end.
+  std::size_t read(void* buf, std::size_t size);
+}; // WktWriter
+
+} // farm_db
@@ -1,30 +1,44 @@
 #include "FarmDb.hpp"
 #include "FarmGeo.hpp"
+#include "FarmWkt.hpp"
+#include "FarmFdb.hpp"
+#include "Deflate.hpp"
+#include "TaskDataIndex.hpp"
 #include "ZipArchive.hpp"
+#include "XmlReader.hpp"
+#include "XmlWriter.hpp"
+#include "parallel.hpp"
 
 #include "get_attr.hpp"
 
-#include <pugixml.hpp>
-
 #include <gsl-lite/gsl-lite.hpp>
 
 #include <boost/geometry/algorithms/is_valid.hpp>
 #include <boost/geometry/algorithms/correct.hpp>
 
-#include <regex>
 #include <string>
 #include <vector>
+#include <deque>
+#include <sstream>
 #include <string_view>
 #include <format>
-#include <sstream>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
 #include <exception>
 #include <ranges>
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
 #include <utility>
+#include <charconv>
+#include <system_error>
 #include <cstdint>
+#include <optional>
+#include <span>
 
 namespace gsl = gsl_lite;
 
@@ -132,10 +146,12 @@ namespace {
 
 namespace fs = std::filesystem;
 
-using XmlNode = pugi::xml_node;
+using XmlWriter = tjg::XmlWriter;
+using XmlReader = tjg::XmlReader;
+using XmlEvent  = tjg::XmlReader::Event;
 
-[[noreturn]] void InvalidNode(const XmlNode& xml, std::string what) {
-  auto k = tjg::name(xml);
+[[noreturn]] void InvalidNode(const XmlReader& xml, std::string what) {
+  auto k = xml.name();
   what.reserve(what.size() + 8 + k.size());
   what += " on <";
   what += k;
@@ -143,7 +159,7 @@ using XmlNode = pugi::xml_node;
   throw std::runtime_error{what};
 } // InvalidNode
 
-[[noreturn]] void InvalidAttr(const XmlNode& xml, const char* key,
+[[noreturn]] void InvalidAttr(const XmlReader& xml, const char* key,
                               std::string what="Invalid attribute")
 {
   auto k = std::string_view{key};
@@ -154,7 +170,7 @@ using XmlNode = pugi::xml_node;
   auto a = xml.attribute(k);
   if (a) {
     what += "= ";
-    what += a.as_string();
+    what += a.value();
   }
   else {
     what += "is missing";
@@ -163,43 +179,61 @@ using XmlNode = pugi::xml_node;
 } // InvalidAttr
 
 template<typename T>
-std::optional<T> GetAttr(const XmlNode& x, const char* key) {
-  const auto& a = x.attribute(key);
+std::optional<T> GetAttr(const XmlReader& x, const char* key) {
+  const auto a = x.attribute(key);
   return (a) ? tjg::try_get_attr<T>(a) : std::nullopt;
 } // GetAttr
 
 template<typename T=std::string>
-T RequireAttr(const pugi::xml_node& x, const char* key) {
-  const auto& a = x.attribute(key);
+T RequireAttr(const XmlReader& x, const char* key) {
+  const auto a = x.attribute(key);
   if (!a)
     InvalidAttr(x, key);
-  auto v = GetAttr<T>(x, key);
+  auto v = tjg::try_get_attr<T>(a);
   if (v)
     return *v;
   if constexpr (std::is_same_v<T, std::string>) {
-    auto s = a.as_string();
+    auto s = a.value();
     if (s[0] != '\0')
       return s;
   }
   InvalidAttr(x, key);
 } // RequireAttr
 
-int GetId(std::string pfx, const std::string& attr) {
-  pfx += "-?([0-9]+)";
-  const auto re = std::regex{pfx};
-  auto m = std::smatch{};
-  if (!std::regex_match(attr, m, re) || m.size() != 2 || !m[1].matched)
+// Calls fn() for each child element of the element the reader is on.  fn()
+// starts on the child's Start event and must leave the reader on its End,
+// either by reading the child's own children or by calling skip().
+template<class F>
+void ForEachChild(XmlReader& xml, F&& fn) {
+  while (xml.next() == XmlEvent::Start)
+    fn();
+} // ForEachChild
+
+// Parses "<pfx>123" or "<pfx>-123"; returns -1 if `attr` is not of that form.
+int GetId(std::string_view pfx, std::string_view attr) noexcept {
+  if (!attr.starts_with(pfx))
+    return -1;
+  attr.remove_prefix(pfx.size());
+  if (attr.starts_with('-'))
+    attr.remove_prefix(1);
+  if (attr.empty() || attr[0] < '0' || attr[0] > '9')
+    return -1;
+  auto id = int{-1};
+  const auto last = attr.data() + attr.size();
+  auto [ptr, ec] = std::from_chars(attr.data(), last, id);
+  if (ec != std::errc{} || ptr != last)
     return -1;
-  return std::stoi(m[1]);
+  return id;
 } // GetId
 
-using IndexDb = std::vector<int>;
+// Maps an element id to its index in the FarmDb vector.
+using IndexDb = std::unordered_map<int, gsl::index>;
 
 gsl::index FindIndex(const IndexDb& db, int id) {
-  auto it = std::ranges::find(db, id);
+  auto it = db.find(id);
   if (it == db.end())
     return gsl::index{-1};
-  return std::distance(db.begin(), it);
+  return it->second;
 } // FindIndex
 
 struct Point {
@@ -210,88 +244,114 @@ struct Point {
     : type{type_}, point{pt_} { }
 }; // Point
 
-Point ReadPoint(const XmlNode& x) {
+// Points are most of a TASKDATA file, so a PNT's attributes are decoded in
+// the one pass that looks for unexpected ones, rather than looked up again.
+isoxml::PointType ReadPoint(XmlReader& x, LatLon& pt) {
+  auto type = std::optional<isoxml::PointType>{};
+  auto lat  = std::optional<double>{};
+  auto lon  = std::optional<double>{};
   for (const auto& a: x.attributes()) {
     auto k = tjg::name(a);
-    if (k == "A" || k == "C" || k == "D")
-      continue;
+    if (k.size() == 1) {
+      switch (k[0]) {
+        case 'A': type = tjg::try_get_attr<isoxml::PointType>(a); continue;
+        case 'C': lat  = tjg::try_get_attr<double>(a);            continue;
+        case 'D': lon  = tjg::try_get_attr<double>(a);            continue;
+        default:  break;
+      }
+    }
     std::cerr << "ReadPoint: extra attribute ignored: " << k << '\n';
   }
-  return Point{RequireAttr<isoxml::PointType>(x, "A"),
-               LatLon{RequireAttr<double>(x, "C") * units::deg,
-                      RequireAttr<double>(x, "D") * units::deg}};
+  if (!type) InvalidAttr(x, "A");
+  // NaN fails these tests too.
+  if (!lat || !(std::abs(*lat) <=  90.0)) InvalidAttr(x, "C");
+  if (!lon || !(std::abs(*lon) <= 180.0)) InvalidAttr(x, "D");
+  pt = LatLon{*lat * units::deg, *lon * units::deg};
+  x.skip();
+  return *type;
 } // ReadPoint
 
-void WritePoint(XmlNode& node, const LatLon& pt, isoxml::PointType type) {
-  using mp_units::si::unit_symbols::deg;
-  auto pnt = node.append_child("PNT");
-  pnt.append_attribute("A") = static_cast<int>(type);
-  pnt.append_attribute("C") = pt.latitude .numerical_value_in(deg);
-  pnt.append_attribute("D") = pt.longitude.numerical_value_in(deg);
+Point ReadPoint(XmlReader& x) {
+  auto pt = Point{};
+  pt.type = ReadPoint(x, pt.point);
+  return pt;
+} // ReadPoint
+
+void WritePoint(XmlWriter& x, const LatLon& pt, isoxml::PointType type) {
+  x.start("PNT");
+  x.attr("A", static_cast<int>(type));
+  x.attr("C", pt.lat());
+  x.attr("D", pt.lon());
+  x.end();
 } // WritePoint
 
-void ReadPoints(std::vector<LatLon>& pts,
-                    const XmlNode& node, isoxml::PointType expPtType)
+// Points are gathered on the heap and copied into `pts`, which is in the
+// arena, at exactly their number: growing `pts` itself would leave every
+// outgrown buffer behind in the arena.
+void ReadPoints(Coords& pts,
+                XmlReader& xml, isoxml::PointType expPtType)
 {
-  gsl_Expects(tjg::name(node) == "LSG");
-  for (const auto& a: node.attributes()) {
+  gsl_Expects(xml.name() == "LSG");
+  thread_local auto scratch = std::vector<LatLon>{};
+  scratch.clear();
+  for (const auto& a: xml.attributes()) {
     auto k = tjg::name(a);
     if (k == "A")
       continue;
     std::cerr << "ReadPoints: extra attribute ignored: " << k << '\n';
   }
-  pts.reserve(std::distance(node.begin(), node.end()));
-  for (const auto& c: node.children()) {
-    if (c.type() != pugi::node_element)
-      continue;
-    auto k = tjg::name(c);
+  ForEachChild(xml, [&] {
+    auto k = xml.name();
     if (k != "PNT") {
       std::cerr << "ReadPoints: element ignored: " <<  k << '\n';
-      continue;
+      xml.skip();
+      return;
     }
-    auto pt = ReadPoint(c);
-    if (pt.type != expPtType) {
+    // Decoded in place; on error the whole read is abandoned anyway.
+    const auto type = ReadPoint(xml, scratch.emplace_back());
+    if (type != expPtType) {
       auto msg = std::string{"ReadPoints: expected "} + Name(expPtType)
-               + ": got " + Name(pt.type);
+               + ": got " + Name(type);
       throw std::runtime_error{msg};
     }
-    pts.push_back(pt.point);
-  }
+  });
+  pts.assign(scratch.begin(), scratch.end());
 } // ReadPoints
 
-void WritePoints(XmlNode& node, const std::vector<LatLon>& pts,
+void WritePoints(XmlWriter& x, const Coords& pts,
                  isoxml::LineStringType lsgType, isoxml::PointType ptType)
 {
-  auto lsg = node.append_child("LSG");
-  lsg.append_attribute("A") = static_cast<int>(lsgType);
+  x.start("LSG");
+  x.attr("A", static_cast<int>(lsgType));
   for (const auto& p: pts)
-    WritePoint(lsg, p, ptType);
+    WritePoint(x, p, ptType);
+  x.end();
 } // WritePoints
 
 [[maybe_unused]]
-Path ReadPath(const XmlNode& node, isoxml::PointType expPtType) {
+Path ReadPath(XmlReader& node, isoxml::PointType expPtType) {
   auto pts = Path{};
   ReadPoints(pts, node, expPtType);
   return pts;
 } // ReadPath
 
 [[maybe_unused]]
-void WritePath(XmlNode& node, const Path& path, isoxml::LineStringType lsgType,
-                                                isoxml::PointType ptType)
-  { WritePoints(node, path, lsgType, ptType); }
+void WritePath(XmlWriter& x, const Path& path, isoxml::LineStringType lsgType,
+                                               isoxml::PointType ptType)
+  { WritePoints(x, path, lsgType, ptType); }
 
-geo::Ring ReadRing(const XmlNode& node, isoxml::PointType expPtType) {
+geo::Ring ReadRing(XmlReader& node, isoxml::PointType expPtType) {
   auto ring = geo::Ring{};
   ReadPoints(ring, node, expPtType);
   ggl::correct(ring);
   return ring;
 } // ReadRing
 
-void WriteRing(XmlNode& node, const geo::Ring& ring,
+void WriteRing(XmlWriter& x, const geo::Ring& ring,
                isoxml::LineStringType lsgType, isoxml::PointType ptType)
-  { WritePoints(node, ring, lsgType, ptType); }
+  { WritePoints(x, ring, lsgType, ptType); }
 
-Path ReadSwathPath(const XmlNode& x) {
+Path ReadSwathPath(XmlReader& x) {
   using namespace isoxml;
   auto lsgType = RequireAttr<LineStringType>(x, "A");
   if (lsgType != LineStringType::Guidance) {
@@ -307,17 +367,16 @@ Path ReadSwathPath(const XmlNode& x) {
   }
   bool firstPt = true;
   bool lastPt  = false;
-  auto pts = Path{};
-  pts.reserve(std::distance(x.begin(), x.end()));
-  for (const auto& c: x.children()) {
-    if (c.type() != pugi::node_element)
-      continue;
-    auto k = tjg::name(c);
+  thread_local auto scratch = std::vector<LatLon>{};  // as in ReadPoints
+  scratch.clear();
+  ForEachChild(x, [&] {
+    auto k = x.name();
     if (k != "PNT") {
       std::cerr << "ReadSwathPath: element ignored: " <<  k << '\n';
-      continue;
+      x.skip();
+      return;
     }
-    auto pt = ReadPoint(c);
+    auto pt = ReadPoint(x);
     bool err = false;
     using namespace isoxml;
     switch (pt.type) {
@@ -331,42 +390,48 @@ Path ReadSwathPath(const XmlNode& x) {
       throw std::runtime_error{msg + Name(pt.type)};
     }
     firstPt = false;
-    pts.push_back(pt.point);
-  }
-  return pts;
+    scratch.push_back(pt.point);
+  });
+  return Path(scratch.begin(), scratch.end());
 } // ReadSwathPath
 
-void WriteSwathPath(XmlNode& node, const Path& path) {
+void WriteSwathPath(XmlWriter& x, const Path& path) {
   using namespace isoxml;
-  auto lsg = node.append_child("LSG");
-  lsg.append_attribute("A") = static_cast<int>(LineStringType::Guidance);
-  if (path.empty())
-    return;
-  auto iter = path.begin();
-  WritePoint(lsg, *iter, PointType::GuideA);
-  if (++iter == path.end())
-    return;
-  const auto last = std::prev(path.end());
-  while (iter != last)
-    WritePoint(lsg, *iter++, PointType::GuidePoint);
-  WritePoint(lsg, *iter, PointType::GuideB);
+  x.start("LSG");
+  x.attr("A", static_cast<int>(LineStringType::Guidance));
+  if (!path.empty()) {
+    auto iter = path.begin();
+    WritePoint(x, *iter, PointType::GuideA);
+    if (++iter != path.end()) {
+      const auto last = std::prev(path.end());
+      while (iter != last)
+        WritePoint(x, *iter++, PointType::GuidePoint);
+      WritePoint(x, *iter, PointType::GuideB);
+    }
+  }
+  x.end();
 } // WriteSwathPath
 
-Polygon ReadPolygon(const XmlNode& x, isoxml::PolygonType polyType,
-                                      isoxml::PointType ptType)
+Polygon ReadPolygon(XmlReader& x, isoxml::PolygonType polyType,
+                                  isoxml::PointType ptType)
 {
   if (RequireAttr<isoxml::PolygonType>(x, "A") != polyType)
     throw std::runtime_error{"ReadPolygon: invalid type"};
   Polygon poly;
-  for (const auto& lsg: x.children("LSG")) {
-    auto ring = ReadRing(lsg, ptType);
-    auto lsgType = RequireAttr<isoxml::LineStringType>(lsg, "A");
+  ForEachChild(x, [&] {
+    if (x.name() != "LSG") {
+      std::cerr << "ReadPolygon: element ignored: " << x.name() << '\n';
+      x.skip();
+      return;
+    }
+    auto lsgType = RequireAttr<isoxml::LineStringType>(x, "A");
+    auto ring = ReadRing(x, ptType);
     using namespace isoxml;
     switch (lsgType) {
       case LineStringType::Exterior:
         if (!poly.outer().empty())
           throw std::runtime_error{"Polygon: multiple exterior rings"};
-        poly.outer() = geo::Ring{ring};
+        poly.outer() = std::move(ring);
         break;
       case LineStringType::Interior:
         poly.inners().emplace_back(std::move(ring));
@@ -377,15 +442,7 @@ Polygon ReadPolygon(const XmlNode& x, isoxml::PolygonType polyType,
         throw std::runtime_error{msg};
       }
     }
-  }
-  for (const auto& c: x.children()) {
-    if (c.type() != pugi::node_element)
-      continue;
-    auto k = tjg::name(c);
-    if (k == "LSG")
-      continue;
-    std::cerr << "ReadPolygon: element ignored: " << k << '\n';
-  }
+  });
   if (poly.outer().empty())
     throw std::runtime_error{"ReadPolygon: missing exterior ring"};
   if (std::ssize(poly.outer()) < 4)
@@ -398,28 +455,29 @@ Polygon ReadPolygon(const XmlNode& x, isoxml::PolygonType polyType,
   return poly;
 } // ReadPolygon
 
-Polygon ReadBoundary(const XmlNode& x) {
+Polygon ReadBoundary(XmlReader& x) {
   using namespace isoxml;
   return ReadPolygon(x, PolygonType::Boundary, PointType::Field);
 }
 
-void WritePolygon(XmlNode& node, const Polygon& poly,
+void WritePolygon(XmlWriter& x, const Polygon& poly,
                   isoxml::PolygonType polyType, isoxml::PointType ptType)
 {
   using namespace isoxml;
-  auto pln = node.append_child("PLN");
-  pln.append_attribute("A") = static_cast<int>(polyType);
-  WriteRing(pln, poly.outer(), LineStringType::Exterior, ptType);
+  x.start("PLN");
+  x.attr("A", static_cast<int>(polyType));
+  WriteRing(x, poly.outer(), LineStringType::Exterior, ptType);
   for (const auto& path: poly.inners())
-    WriteRing(pln, path, LineStringType::Interior, ptType);
+    WriteRing(x, path, LineStringType::Interior, ptType);
+  x.end();
 } // WritePolygon
 
-void WriteBoundary(XmlNode& node, const Polygon& poly) {
+void WriteBoundary(XmlWriter& x, const Polygon& poly) {
   using namespace isoxml;
-  WritePolygon(node, poly, PolygonType::Boundary, PointType::Field);
+  WritePolygon(x, poly, PolygonType::Boundary, PointType::Field);
 } // WriteBoundary
 
-Swath ReadSwath(const XmlNode& node) {
+Swath ReadSwath(XmlReader& node, tjg::StringPool& strings) {
   using namespace isoxml;
   auto idStr = RequireAttr<std::string>(node, "A");
   auto id = GetId("GGP", idStr);
@@ -439,25 +497,24 @@ Swath ReadSwath(const XmlNode& node) {
   auto extension = std::optional<Swath::Extension>{};
   auto method    = std::optional<Swath::Method>{};
   auto heading   = std::optional<HdgDeg>{};
-  auto otherAttr = std::vector<Attribute>{};
-  for (const auto& c: node.children()) {
-    if (c.type() != pugi::node_element)
-      continue;
-    auto k = tjg::name(c);
+  auto otherAttr = Attributes{};
+  ForEachChild(node, [&] {
+    auto k = node.name();
     if (k != "GPN") {
       std::cerr << "ReadSwath: ignored guide element: " << k << '\n';
-      continue;
+      node.skip();
+      return;
     }
     if (!path.empty())
       throw std::runtime_error{"ReadSwath: too many swaths"};
-    auto swIdStr = RequireAttr<std::string>(c, "A");
+    auto swIdStr = RequireAttr<std::string>(node, "A");
     auto swId = GetId("GPN", swIdStr);
     if (swId != id) {
       throw std::runtime_error{
                         "ReadSwath: id mismatch: " + idStr + " != " + swIdStr};
     }
-    type = RequireAttr<Swath::Type>(c, "C");
-    for (const auto& a: c.attributes()) {
+    type = RequireAttr<Swath::Type>(node, "C");
+    for (const auto& a: node.attributes()) {
       using mp_units::si::unit_symbols::deg;
       auto k = tjg::name(a);
       if (k == "A" || k == "C")
@@ -481,16 +538,18 @@ Swath ReadSwath(const XmlNode& node) {
       else if (k == "I") {
         method = tjg::get_attr<Swath::Method>(a);
       }
-      else otherAttr.emplace_back(k, a.value());
-    }
-    for (const auto& p: c.children()) {
-      if (p.type() != pugi::node_element)
-        continue;
-      auto k = tjg::name(p);
-      if (k == "LSG") path = ReadSwathPath(p);
-      else std::cerr << "ReadSwath: ignored element: " << k << '\n';
+      else otherAttr.emplace_back(strings, k, a.value());
     }
-  }
+    ForEachChild(node, [&] {
+      auto k = node.name();
+      if (k == "LSG") {
+        path = ReadSwathPath(node);
+      } else {
+        std::cerr << "ReadSwath: ignored element: " << k << '\n';
+        node.skip();
+      }
+    });
+  });
   if (path.empty())
     throw std::runtime_error{"ReadSwath: missing path"};
   auto swath = Swath{std::move(name), type};
@@ -504,114 +563,124 @@ Swath ReadSwath(const XmlNode& node) {
   return swath;
 } // ReadSwath
 
-void WriteSwath(XmlNode& node, const Swath& swath, int id) {
+void WriteSwath(XmlWriter& x, const Swath& swath, int id) {
   using mp_units::si::unit_symbols::deg;
   using namespace isoxml;
   const auto idStr = std::to_string(id);
-  auto ggp = node.append_child("GGP");
-  ggp.append_attribute("A") = "GGP" + idStr;
+  x.start("GGP");
+  x.attr("A", "GGP" + idStr);
   auto name = swath.name;
   if (name.empty()) name = "Swath" + idStr;
-  ggp.append_attribute("B") = name;
-  auto gpn = ggp.append_child("GPN");
-  gpn.append_attribute("A") = "GPN" + idStr;
-  gpn.append_attribute("B") = name;
-  gpn.append_attribute("C") = static_cast<int>(swath.type);
+  x.attr("B", name);
+  x.start("GPN");
+  x.attr("A", "GPN" + idStr);
+  x.attr("B", name);
+  x.attr("C", static_cast<int>(swath.type));
   if (swath.option)
-    gpn.append_attribute("D") = static_cast<int>(*swath.option);
-  gpn.append_attribute("E") =
-            static_cast<int>(swath.direction.value_or(Swath::Direction::Both));
-  gpn.append_attribute("F") =
-            static_cast<int>(swath.extension.value_or(Swath::Extension::Both));
-  gpn.append_attribute("G") =
-            swath.heading.value_or(0.0 * deg).numerical_value_in(deg);
-  gpn.append_attribute("I") =
-            static_cast<int>(swath.method.value_or(Swath::Method::NoGps));
+    x.attr("D", static_cast<int>(*swath.option));
+  x.attr("E",
+         static_cast<int>(swath.direction.value_or(Swath::Direction::Both)));
+  x.attr("F",
+         static_cast<int>(swath.extension.value_or(Swath::Extension::Both)));
+  x.attr("G", swath.heading.value_or(0.0 * deg).numerical_value_in(deg));
+  x.attr("I", static_cast<int>(swath.method.value_or(Swath::Method::NoGps)));
 #if 0
   if (swath.direction)
-    gpn.append_attribute("E") = static_cast<int>(*swath.direction);
+    x.attr("E", static_cast<int>(*swath.direction));
   if (swath.extension)
-    gpn.append_attribute("F") = static_cast<int>(*swath.extension);
+    x.attr("F", static_cast<int>(*swath.extension));
   if (swath.heading)
-    gpn.append_attribute("G") = swath.heading->numerical_value_in(deg);
+    x.attr("G", swath.heading->numerical_value_in(deg));
   if (swath.method)
-    gpn.append_attribute("I") = static_cast<int>(*swath.method);
+    x.attr("I", static_cast<int>(*swath.method));
 #endif
   for (const auto& [k, v]: swath.otherAttr)
-    gpn.append_attribute(k) = v;
-  WriteSwathPath(gpn, swath.path);
+    x.attr(k, v);
+  WriteSwathPath(x, swath.path);
+  x.end(); // GPN
+  x.end(); // GGP
 } // WriteSwath
 
-void WriteCustomer(XmlNode& node, const Customer& cust, int id) {
-  auto ctr = node.append_child("CTR");
-  ctr.append_attribute("A") = "CTR" + std::to_string(id);
-  ctr.append_attribute("B") = cust.name;
+void WriteCustomer(XmlWriter& x, const Customer& cust, int id) {
+  x.start("CTR");
+  x.attr("A", "CTR" + std::to_string(id));
+  x.attr("B", cust.name);
   for (const auto& [k, v]: cust.otherAttr)
-    ctr.append_attribute(k) = v;
+    x.attr(k, v);
+  x.end();
 } // WriteCustomer
 
-void WriteFarm(XmlNode& node, const Farm& farm, int id, int custId) {
-  auto frm = node.append_child("FRM");
-  frm.append_attribute("A") = "FRM" + std::to_string(id);
-  frm.append_attribute("B") = farm.name;
-  if (custId != 0) frm.append_attribute("I") = "CTR" + std::to_string(custId);
+void WriteFarm(XmlWriter& x, const Farm& farm, int id, int custId) {
+  x.start("FRM");
+  x.attr("A", "FRM" + std::to_string(id));
+  x.attr("B", farm.name);
+  if (custId != 0) x.attr("I", "CTR" + std::to_string(custId));
   for (const auto& [k, v]: farm.otherAttr)
-    frm.append_attribute(k) = v;
+    x.attr(k, v);
+  x.end();
 } // WriteFarm
 
-void WriteField(XmlNode& node, const Field& field, int id,
-                int custId, int farmId, int& swathId)
+// Writes the PFD start tag; boundaries and swaths follow, then x.end().
+void WriteFieldStart(XmlWriter& x, const Field& field, int id,
+                     int custId, int farmId)
 {
-  auto pfd = node.append_child("PFD");
-  pfd.append_attribute("A") = "PFD" + std::to_string(id);
-  pfd.append_attribute("C") = field.name;
-  pfd.append_attribute("D") = 0;
-  if (custId != 0) pfd.append_attribute("E") = "CTR" + std::to_string(custId);
-  if (farmId != 0) pfd.append_attribute("F") = "FRM" + std::to_string(farmId);
+  x.start("PFD");
+  x.attr("A", "PFD" + std::to_string(id));
+  x.attr("C", field.name);
+  x.attr("D", 0);
+  if (custId != 0) x.attr("E", "CTR" + std::to_string(custId));
+  if (farmId != 0) x.attr("F", "FRM" + std::to_string(farmId));
   for (const auto& [k, v]: field.otherAttr)
-    pfd.append_attribute(k) = v;
-  for (const auto& p: field.parts)
-    WriteBoundary(pfd, p);
-  for (const auto& s: field.swaths)
-    WriteSwath(pfd, s, ++swathId);
-} // WriteField
+    x.attr(k, v);
+} // WriteFieldStart
 
 } // local
 
 FarmDb FarmDb::ReadXml(const fs::path& input) {
-  auto doc = pugi::xml_document{};
-
   auto ext = input.extension();
-
-  if (ext == ".xml" || ext == ".XML") {
-    auto res = doc.load_file(input.c_str(),
-                             pugi::parse_default | pugi::parse_ws_pcdata);
-    if (!res) {
-      auto msg = std::format("{}: XML parse error: {} (offset {})",
-                             input.string(), res.description(), res.offset);
-      throw std::runtime_error{msg};
-    }
-  }
-  else {
+  if (ext != ".xml" && ext != ".XML") {
     auto msg = std::string{"FarmDb::ReadXml: invalid filename extension: "}
              + input.string();
     throw std::runtime_error{msg};
   }
+  auto xml = XmlReader{input};
+  return ReadXml(xml);
+} // FarmDb::ReadXml
 
-  auto root = doc.child(isoxml::Root);
-  if (!root) {
-    auto msg = std::format("{}: missing root <{}>",
-                           input.string(), isoxml::Root);
-    throw std::runtime_error{msg};
-  }
+namespace {
 
-  FarmDb db;
-  db.versionMajor = RequireAttr<int>(root, isoxml::root_attr::VersionMajor);
-  db.versionMinor = RequireAttr<int>(root, isoxml::root_attr::VersionMinor);
-  auto custDb  = IndexDb{};
-  auto farmDb  = IndexDb{};
-  auto fieldDb = IndexDb{};
-  for (const auto& a : root.attributes()) {
+// Builds a FarmDb from the children of the root element, one at a time, so
+// that a TaskDataIndex can feed it just the elements it wants.  Customers
+// must come before the farms and fields that refer to them, and farms before
+// their fields, as they do in a TASKDATA file.  The caller selects the
+// FarmDb's arena.
+class TaskDataReader {
+  FarmDb& _db;
+  tjg::StringPool& _strings;
+  IndexDb _custDb;
+  IndexDb _farmDb;
+  IndexDb _fieldDb;
+
+  void customer(XmlReader& xml);
+  void farm(XmlReader& xml);
+  void field(XmlReader& xml);
+
+public:
+  explicit TaskDataReader(FarmDb& db) : _db{db}, _strings{*db.strings} { }
+
+  /// Reads the attributes of the root start tag.
+  void root(const XmlReader& xml);
+
+  /// Reads one child of the root, starting on its Start and leaving the
+  /// reader on its End.
+  void child(XmlReader& xml);
+}; // TaskDataReader
+
+void TaskDataReader::root(const XmlReader& xml) {
+  auto& db = _db;
+  db.versionMajor = RequireAttr<int>(xml, isoxml::root_attr::VersionMajor);
+  db.versionMinor = RequireAttr<int>(xml, isoxml::root_attr::VersionMinor);
+  for (const auto& a : xml.attributes()) {
     const auto k = tjg::name(a);
     if (   k == isoxml::root_attr::VersionMajor
         || k == isoxml::root_attr::VersionMinor)
@@ -623,189 +692,475 @@ FarmDb FarmDb::ReadXml(const fs::path& input) {
     else if (k == isoxml::root_attr::MgmtSoftwareVersion)
       db.swVersion = tjg::get_attr<std::string>(a);
     else
-      db.otherAttr.emplace_back(k, a.value());
+      db.otherAttr.emplace_back(_strings, k, a.value());
   }
   if (db.versionMajor < 0 || db.versionMinor < 0)
     throw std::runtime_error{"ReadFarmDb: missing VersionMajor/VersionMinor"};
-  for (const auto& c: root.children()) {
-    if (c.type() != pugi::node_element)
+} // root
+
+void TaskDataReader::customer(XmlReader& xml) {
+  auto& db = _db;
+  auto idStr = RequireAttr<std::string>(xml ,"A");
+  auto id = GetId("CTR", idStr);
+  if (id < 0)
+    throw std::runtime_error{"ReadFarmDb: invalid customer id: " + idStr};
+  if (!_custDb.try_emplace(id, std::ssize(db.customers)).second)
+    throw std::runtime_error{"ReadFarmDb: duplicate customer: " + idStr};
+  auto cust = std::make_unique<Customer>(RequireAttr<std::string>(xml, "B"));
+  for (const auto& a: xml.attributes()) {
+    auto k = tjg::name(a);
+    if (k == "A" || k == "B")
       continue;
-    auto k = tjg::name(c);
-    if (k == "CTR") {
-      auto idStr = RequireAttr<std::string>(c ,"A");
-      auto id = GetId("CTR", idStr);
-      if (id < 0)
-        throw std::runtime_error{"ReadFarmDb: invalid customer id: " + idStr};
-      if (std::ranges::contains(custDb, id))
-        throw std::runtime_error{"ReadFarmDb: duplicate customer: " + idStr};
-      auto cust = std::make_unique<Customer>(RequireAttr<std::string>(c, "B"));
-      for (const auto& a: c.attributes()) {
-        auto k = tjg::name(a);
-        if (k == "A" || k == "B")
-          continue;
-        cust->otherAttr.emplace_back(a.name(), a.value());
+    cust->otherAttr.emplace_back(_strings, k, a.value());
+  }
+  db.customers.emplace_back(std::move(cust));
+  xml.skip();
+} // customer
+
+void TaskDataReader::farm(XmlReader& xml) {
+  auto& db = _db;
+  auto idStr = RequireAttr<std::string>(xml ,"A");
+  auto id = GetId("FRM", idStr);
+  if (id < 0)
+    throw std::runtime_error{"ReadFarmDb: invalid farm id: " + idStr};
+  if (!_farmDb.try_emplace(id, std::ssize(db.farms)).second)
+    throw std::runtime_error{"ReadFarmDb: duplicate farm: " + idStr};
+  auto farm = std::make_unique<Farm>(RequireAttr<std::string>(xml, "B"));
+  for (const auto& a: xml.attributes()) {
+    auto k = tjg::name(a);
+    if (k == "A" || k == "B")
+      continue;
+    if (k == "I") {
+      auto ctrIdStr = tjg::get_attr<std::string>(a);
+      auto ctrIdx = FindIndex(_custDb, GetId("CTR", ctrIdStr));
+      if (ctrIdx < 0) {
+        throw std::runtime_error{"ReadFarm: invalid customer id: "
+                                 + ctrIdStr};
       }
-      custDb.push_back(id);
-      db.customers.emplace_back(std::move(cust));
+      auto cust = db.customers[ctrIdx].get();
+      farm->customer = cust;
     }
-    else if (k == "FRM") {
-      auto idStr = RequireAttr<std::string>(c ,"A");
-      auto id = GetId("FRM", idStr);
-      if (id < 0)
-        throw std::runtime_error{"ReadFarmDb: invalid farm id: " + idStr};
-      if (std::ranges::contains(farmDb, id))
-        throw std::runtime_error{"ReadFarmDb: duplicate farm: " + idStr};
-      auto farm = std::make_unique<Farm>(RequireAttr<std::string>(c, "B"));
-      for (const auto& a: c.attributes()) {
-        auto k = tjg::name(a);
-        if (k == "A" || k == "B")
-          continue;
-        if (k == "I") {
-          auto ctrIdStr = tjg::get_attr<std::string>(a);
-          auto ctrIdx = FindIndex(custDb, GetId("CTR", ctrIdStr));
-          if (ctrIdx < 0) {
-            throw std::runtime_error{"ReadFarm: invalid customer id: "
-                                     + ctrIdStr};
-          }
-          auto cust = db.customers[ctrIdx].get();
-          farm->customer = cust;
-        }
-        else farm->otherAttr.emplace_back(a.name(), a.value());
+    else farm->otherAttr.emplace_back(_strings, k, a.value());
+  }
+  auto ptr = farm.get();
+  db.farms.emplace_back(std::move(farm));
+  if (ptr->customer)
+    ptr->customer->farms.push_back(ptr);
+  xml.skip();
+} // farm
+
+void TaskDataReader::field(XmlReader& xml) {
+  auto& db = _db;
+  const auto idStr = RequireAttr<std::string>(xml, "A");
+  auto id = GetId("PFD", idStr);
+  if (id < 0)
+    throw std::runtime_error{"ReadFarmDb: invalid field id: " + idStr};
+  if (!_fieldDb.try_emplace(id, std::ssize(db.fields)).second)
+    throw std::runtime_error{"ReadFarmDb: duplicate field: " + idStr};
+  if (RequireAttr<int>(xml, "D") != 0)
+    throw std::runtime_error{"ReadFarmDb: non-zero field area"};
+  auto field = std::make_unique<Field>(RequireAttr<std::string>(xml, "C"));
+  for (const auto& a: xml.attributes()) {
+    auto k = tjg::name(a);
+    if (k == "A" || k == "C" || k == "D")
+      continue;
+    if (k == "E") {
+      auto ctrIdStr = tjg::get_attr<std::string>(a);
+      auto ctrIdx = FindIndex(_custDb, GetId("CTR", ctrIdStr));
+      if (ctrIdx < 0) {
+        throw std::runtime_error{
+                            "ReadFarmDb: invalid customer id: " + ctrIdStr};
+      }
+      if (field->customer) {
+        throw std::runtime_error{
+                        "ReadFarmDb: field already belongs to a customer"};
       }
-      auto ptr = farm.get();
-      farmDb.push_back(id);
-      db.farms.emplace_back(std::move(farm));
-      if (ptr->customer)
-        ptr->customer->farms.push_back(ptr);
+      field->customer = db.customers[ctrIdx].get();
     }
-    else if (k == "PFD") {
-      const auto idStr = RequireAttr<std::string>(c, "A");
-      auto id = GetId("PFD", idStr);
-      if (id < 0)
-        throw std::runtime_error{"ReadFarmDb: invalid field id: " + idStr};
-      if (std::ranges::contains(fieldDb, id))
-        throw std::runtime_error{"ReadFarmDb: duplicate field: " + idStr};
-      if (RequireAttr<int>(c, "D") != 0)
-        throw std::runtime_error{"ReadFarmDb: non-zero field area"};
-      auto field = std::make_unique<Field>(RequireAttr<std::string>(c, "C"));
-      for (const auto& a: c.attributes()) {
-        auto k = tjg::name(a);
-        if (k == "A" || k == "C" || k == "D")
-          continue;
-        if (k == "E") {
-          auto ctrIdStr = tjg::get_attr<std::string>(a);
-          auto ctrIdx = FindIndex(custDb, GetId("CTR", ctrIdStr));
-          if (ctrIdx < 0) {
-            throw std::runtime_error{
-                                "ReadFarmDb: invalid customer id: " + ctrIdStr};
-          }
-          if (field->customer) {
-            throw std::runtime_error{
-                            "ReadFarmDb: field already belongs to a customer"};
-          }
-          field->customer = db.customers[ctrIdx].get();
-        }
-        else if (k == "F") {
-          auto frmIdStr = tjg::get_attr<std::string>(a);
-          auto frmIdx = FindIndex(farmDb, GetId("FRM", frmIdStr));
-          if (frmIdx < 0) {
-            throw std::runtime_error{
-                                    "ReadFarmDb: invalid farm id: " + frmIdStr};
-          }
-          if (field->farm) {
-            throw std::runtime_error{
-                                "ReadFarmDb: field already belongs to a farm"};
-          }
-          field->farm = db.farms[frmIdx].get();
-        }
-        else field->otherAttr.emplace_back(k, a.value());
+    else if (k == "F") {
+      auto frmIdStr = tjg::get_attr<std::string>(a);
+      auto frmIdx = FindIndex(_farmDb, GetId("FRM", frmIdStr));
+      if (frmIdx < 0) {
+        throw std::runtime_error{
+                                "ReadFarmDb: invalid farm id: " + frmIdStr};
       }
-      if (field->farm && field->farm->customer != field->customer)
-        throw std::runtime_error{"ReadFarmDb: field/farm customer mismatch"};
-      for (const auto& p: c.children()) {
-        if (p.type() != pugi::node_element)
-          continue;
-        auto k = tjg::name(p);
-        if      (k == "PLN") field->parts.emplace_back(ReadBoundary(p));
-        else if (k == "GGP") field->swaths.emplace_back(ReadSwath(p));
-        else std::cerr << "ReadFarmDb: ignored field element " << k << '\n';
+      if (field->farm) {
+        throw std::runtime_error{
+                            "ReadFarmDb: field already belongs to a farm"};
       }
-      field->sortByArea();
-      auto ptr = field.get();
-      fieldDb.push_back(id);
-      db.fields.emplace_back(std::move(field));
-      if (ptr->farm)
-        ptr->farm->fields.push_back(ptr);
+      field->farm = db.farms[frmIdx].get();
+    }
+    else field->otherAttr.emplace_back(_strings, k, a.value());
+  }
+  if (field->farm && field->farm->customer != field->customer)
+    throw std::runtime_error{"ReadFarmDb: field/farm customer mismatch"};
+  ForEachChild(xml, [&] {
+    auto k = xml.name();
+    if      (k == "PLN") field->parts.emplace_back(ReadBoundary(xml));
+    else if (k == "GGP") field->swaths.push_back(ReadSwath(xml, _strings));
+    else {
+      std::cerr << "ReadFarmDb: ignored field element " << k << '\n';
+      xml.skip();
+    }
+  });
+  field->sortByArea();
+  auto ptr = field.get();
+  db.fields.emplace_back(std::move(field));
+  if (ptr->farm)
+    ptr->farm->fields.push_back(ptr);
+} // field
+
+void TaskDataReader::child(XmlReader& xml) {
+  auto k = xml.name();
+  if      (k == "CTR") customer(xml);
+  else if (k == "FRM") farm(xml);
+  else if (k == "PFD") field(xml);
+  else if (k == "VPN") xml.skip();
+  else {
+    std::cerr << "ReadFarmDb: ignored element " << k << '\n';
+    xml.skip();
+  }
+} // child
+
+// Advances `xml` to the root start tag.
+void FindRoot(XmlReader& xml) {
+  for (;;) {
+    if (xml.next() == XmlEvent::Eof) {
+      auto msg = std::format("{}: missing root <{}>",
+                             xml.source(), isoxml::Root);
+      throw std::runtime_error{msg};
     }
-    else if (k == "VPN") { }
-    else std::cerr << "ReadFarmDb: ignored element " << k << '\n';
+    if (xml.name() == isoxml::Root)
+      return;
+    xml.skip();
   }
+} // FindRoot
+
+} // local
+
+FarmDb FarmDb::ReadXml(tjg::XmlReader& xml) {
+  // Elements are consumed as they stream past; only the FarmDb grows.
+  FindRoot(xml);
+  FarmDb db;
+  auto arena = tjg::ArenaScope{*db.arena};
+  auto reader = TaskDataReader{db};
+  reader.root(xml);
+  ForEachChild(xml, [&] { reader.child(xml); });
   return db;
 } // FarmDb::ReadXml
 
+// ---------------------------------------------------------------------
+// TaskDataIndex
+
 namespace {
 
-pugi::xml_document CreateDoc(const FarmDb& db) {
-  auto doc = pugi::xml_document{};
+constexpr auto TaskDataEntry = "TASKDATA/TASKDATA.XML";
+
+// The document as seekable bytes: the file itself, or the TASKDATA.XML of a
+// zip, which can only be decompressed forward and so is reopened to go back.
+class DocSource {
+  fs::path _path;
+  std::string _source;
+  std::ifstream _is;
+  ZipArchive _zip;
+  ZipArchive::File _entry;
+  std::uint64_t _pos = 0;
+
+  void openEntry() {
+    _entry.close();
+    _entry = _zip.file(TaskDataEntry);
+    if (!_entry)
+      throw std::runtime_error{_path.generic_string() + ": cannot find "
+                               + TaskDataEntry};
+    _entry.open();
+    _pos = 0;
+  } // openEntry
+
+public:
+  DocSource(const fs::path& path, bool zipped) : _path{path} {
+    if (zipped) {
+      _zip.open(path, ZIP_RDONLY);
+      openEntry();
+      _source = (path / TaskDataEntry).generic_string();
+    }
+    else {
+      _is.open(path, std::ios::binary);
+      if (!_is)
+        throw std::runtime_error{"cannot open '" + path.string() + "'"};
+      _source = path.generic_string();
+    }
+  } // ctor
+
+  DocSource(const DocSource&) = delete;
+  DocSource& operator=(const DocSource&) = delete;
 
-  auto decl = doc.prepend_child(pugi::node_declaration);
-  decl.append_attribute("version")  = "1.0";
-  decl.append_attribute("encoding") = "utf-8";
-  auto root = doc.append_child(isoxml::Root);
-  for (const auto& [k, v]: db.otherAttr)
-    root.append_attribute(k) = v;
-  if (db.versionMajor < 0 || db.versionMinor < 0) {
-    auto msg = std::format("WriteFarmDb: invalid version: {}.{}",
-                           db.versionMajor, db.versionMinor);
+  ~DocSource() noexcept {
+    auto err = 0;
+    (void) _entry.close(&err);
+  } // dtor
+
+  const std::string& source() const noexcept { return _source; }
+
+  std::size_t read(char* buf, std::size_t size) {
+    auto n = std::size_t{0};
+    if (_entry) {
+      n = _entry.read(buf, size);
+    }
+    else {
+      _is.read(buf, static_cast<std::streamsize>(size));
+      n = static_cast<std::size_t>(_is.gcount());
+    }
+    _pos += n;
+    return n;
+  } // read
+
+  void seek(std::uint64_t offset) {
+    if (!_entry) {
+      _is.clear();
+      _is.seekg(static_cast<std::streamoff>(offset));
+      if (!_is)
+        throw std::runtime_error{_source + ": cannot seek"};
+      _pos = offset;
+      return;
+    }
+    if (offset < _pos)
+      openEntry();
+    auto skip = std::vector<char>(64 * 1024);
+    while (_pos != offset) {
+      const auto want = std::min<std::uint64_t>(skip.size(), offset - _pos);
+      if (read(skip.data(), static_cast<std::size_t>(want)) == 0)
+        throw std::runtime_error{_source + ": index past end of document"};
+    }
+  } // seek
+}; // DocSource
+
+} // local
+
+TaskDataIndex TaskDataIndex::Scan(const fs::path& input) {
+  auto index = TaskDataIndex{};
+  index._path = input;
+  const auto ext = input.extension();
+  if (ext == ".zip") {
+    index._zipped = true;
+  }
+  else if (ext != ".xml" && ext != ".XML") {
+    auto msg = std::string{"TaskDataIndex::Scan: invalid filename extension: "}
+             + input.string();
     throw std::runtime_error{msg};
   }
-  root.append_attribute(isoxml::root_attr::VersionMajor) = db.versionMajor;
-  root.append_attribute(isoxml::root_attr::VersionMinor) = db.versionMinor;
-  root.append_attribute(isoxml::root_attr::MgmtSoftwareManufacturer) =
-                                                           db.swVendor;
-  root.append_attribute(isoxml::root_attr::MgmtSoftwareVersion) =
-                                                           db.swVersion;
-  if (db.dataTransferOrigin != -1) {
-    root.append_attribute(isoxml::root_attr::DataTransferOrigin) =
-                                                          db.dataTransferOrigin;
+  auto src = DocSource{input, index._zipped};
+  auto xml = XmlReader{
+      [&src](char* buf, std::size_t size) { return src.read(buf, size); },
+      src.source()};
+  FindRoot(xml);
+  index._root.begin = xml.offset();
+
+  // Each element ends where the next child of the root, or the root's end
+  // tag, begins.
+  auto starts = std::vector<std::uint64_t>{};
+  auto fieldIds = std::unordered_map<std::string, std::size_t>{};
+  while (xml.next() == XmlEvent::Start) {
+    const auto offset = xml.offset();
+    starts.push_back(offset);
+    const auto k = xml.name();
+    if (k == "CTR") {
+      auto idStr = RequireAttr<std::string>(xml, "A");
+      if (!index._customers.try_emplace(idStr, Extent{offset, 0}).second)
+        throw std::runtime_error{"ReadFarmDb: duplicate customer: " + idStr};
+    }
+    else if (k == "FRM") {
+      auto idStr = RequireAttr<std::string>(xml, "A");
+      auto entry = FarmEntry{{offset, 0},
+                             GetAttr<std::string>(xml, "I").value_or("")};
+      if (!index._farms.try_emplace(idStr, std::move(entry)).second)
+        throw std::runtime_error{"ReadFarmDb: duplicate farm: " + idStr};
+    }
+    else if (k == "PFD") {
+      auto entry = FieldEntry{};
+      entry.id       = RequireAttr<std::string>(xml, "A");
+      entry.name     = GetAttr<std::string>(xml, "C").value_or("");
+      entry.customer = GetAttr<std::string>(xml, "E").value_or("");
+      entry.farm     = GetAttr<std::string>(xml, "F").value_or("");
+      entry.extent   = {offset, 0};
+      if (!fieldIds.try_emplace(entry.id, index._fields.size()).second)
+        throw std::runtime_error{"ReadFarmDb: duplicate field: " + entry.id};
+      index._fields.push_back(std::move(entry));
+    }
+    xml.skip();
   }
+  starts.push_back(xml.offset());
 
-  auto findCustId = [&](const Customer* cust) -> int {
-    for (auto iter = db.customers.cbegin(); iter != db.customers.cend(); ++iter)
-    {
-      if (iter->get() == cust)
-        return static_cast<int>(std::distance(db.customers.cbegin(), iter) + 1);
-    }
-    return 0;
+  auto endOf = [&starts](std::uint64_t begin) {
+    return *std::ranges::upper_bound(starts, begin);
   };
-
-  auto findFarmId = [&](const Farm* farm) -> int {
-    for (auto iter = db.farms.cbegin(); iter != db.farms.cend(); ++iter) {
-      if (iter->get() == farm)
-        return static_cast<int>(std::distance(db.farms.cbegin(), iter) + 1);
-    }
-    return 0;
+  index._root.end = endOf(index._root.begin);
+  for (auto& [id, e]: index._customers)
+    e.end = endOf(e.begin);
+  for (auto& [id, f]: index._farms)
+    f.extent.end = endOf(f.extent.begin);
+  for (auto& f: index._fields)
+    f.extent.end = endOf(f.extent.begin);
+  return index;
+} // TaskDataIndex::Scan
+
+std::optional<std::size_t> TaskDataIndex::find(std::string_view key) const {
+  for (auto i = std::size_t{0}; i != _fields.size(); ++i) {
+    if (_fields[i].id == key)
+      return i;
+  }
+  for (auto i = std::size_t{0}; i != _fields.size(); ++i) {
+    if (_fields[i].name == key)
+      return i;
+  }
+  return std::nullopt;
+} // TaskDataIndex::find
+
+FarmDb TaskDataIndex::load(std::span<const std::size_t> which) const {
+  // A reference missing from the index is left for TaskDataReader to
+  // report, as ReadXml would.
+  auto extents = std::vector<Extent>{_root};
+  auto addCustomer = [&](const std::string& id) {
+    auto it = _customers.find(id);
+    if (it != _customers.end())
+      extents.push_back(it->second);
   };
-
-  for (int i = 0; i != std::ssize(db.customers); ++i)
-    WriteCustomer(root, *db.customers[i], i+1);
-  for (int i = 0; i != std::ssize(db.farms); ++i) {
-    const auto& farm = *db.farms[i];
-    WriteFarm(root, farm, i+1, findCustId(farm.customer));
+  for (auto i: which) {
+    if (i >= _fields.size())
+      throw std::out_of_range{"TaskDataIndex::load: bad field index"};
+    const auto& f = _fields[i];
+    extents.push_back(f.extent);
+    addCustomer(f.customer);
+    auto it = _farms.find(f.farm);
+    if (it != _farms.end()) {
+      extents.push_back(it->second.extent);
+      addCustomer(it->second.customer);
+    }
   }
-  int swathId = 0;
-  for (int i = 0; i != std::ssize(db.fields); ++i) {
-    const auto& field = *db.fields[i];
-    WriteField(root, field, i+1,
-               findCustId(field.customer), findFarmId(field.farm), swathId);
+  auto byBegin = [](const Extent& a, const Extent& b)
+    { return a.begin < b.begin; };
+  auto sameBegin = [](const Extent& a, const Extent& b)
+    { return a.begin == b.begin; };
+  std::ranges::sort(extents, byBegin);
+  const auto dups = std::ranges::unique(extents, sameBegin);
+  extents.erase(dups.begin(), dups.end());
+
+  auto db = FarmDb{};
+  auto arena = tjg::ArenaScope{*db.arena};
+  auto reader = TaskDataReader{db};
+  auto src = DocSource{_path, _zipped};
+  for (const auto& e: extents) {
+    src.seek(e.begin);
+    auto left = e.end - e.begin;
+    auto xml = XmlReader{
+        [&src, &left](char* buf, std::size_t size) {
+          size = static_cast<std::size_t>(std::min<std::uint64_t>(size, left));
+          const auto n = src.read(buf, size);
+          left -= n;
+          return n;
+        },
+        src.source(), e.begin};
+    if (xml.next() != XmlEvent::Start)
+      throw std::runtime_error{src.source() + ": stale TaskDataIndex"};
+    if (e.begin == _root.begin) {
+      if (xml.name() != isoxml::Root)
+        throw std::runtime_error{src.source() + ": stale TaskDataIndex"};
+      reader.root(xml);
+    }
+    else {
+      reader.child(xml);
+    }
   }
+  return db;
+} // TaskDataIndex::load
+
+namespace {
+
+// Produces the TASKDATA document a piece at a time: the header, each
+// customer, farm, field boundary and swath, and the trailer.  Only the
+// current piece is buffered, so memory does not grow with the number of
+// swaths.  The output is identical to what pugixml's save(os, "  ") wrote
+// for the equivalent DOM.
+class TaskDataWriter {
+  enum class Stage {
+    Header, Customers, Farms, FieldStart, Parts, Swaths, FieldEnd, Values,
+    Trailer, Done
+  };
+
+  static constexpr std::size_t FlushSize = 1024 * 1024;
+
+  const FarmDb& _db;
+  XmlWriter _xml;
+  Stage _stage = Stage::Header;
+  std::size_t _i = 0;   // customer, farm, field or value index
+  std::size_t _j = 0;   // part or swath index within the field
+  int _swathId = 0;
+  std::size_t _pos = 0; // bytes of _xml already handed to read()
+
+  // One-based ids in vector order; zero for none.
+  std::unordered_map<const Customer*, int> _custIds;
+  std::unordered_map<const Farm*, int> _farmIds;
+
+  int findCustId(const Customer* cust) const {
+    auto it = _custIds.find(cust);
+    return (it != _custIds.end()) ? it->second : 0;
+  } // findCustId
+
+  int findFarmId(const Farm* farm) const {
+    auto it = _farmIds.find(farm);
+    return (it != _farmIds.end()) ? it->second : 0;
+  } // findFarmId
+
+  void writeHeader();
+  void writeValue(std::size_t i);
+
+public:
+  explicit TaskDataWriter(const FarmDb& db) : _db{db}, _xml{"  "} {
+    if (db.versionMajor < 0 || db.versionMinor < 0) {
+      auto msg = std::format("WriteFarmDb: invalid version: {}.{}",
+                             db.versionMajor, db.versionMinor);
+      throw std::runtime_error{msg};
+    }
+    _custIds.reserve(db.customers.size());
+    for (auto i = std::size_t{0}; i != db.customers.size(); ++i)
+      _custIds.emplace(db.customers[i].get(), static_cast<int>(i+1));
+    _farmIds.reserve(db.farms.size());
+    for (auto i = std::size_t{0}; i != db.farms.size(); ++i)
+      _farmIds.emplace(db.farms[i].get(), static_cast<int>(i+1));
+  } // ctor
+
+  /// Appends the next piece of the document to the buffer; false when done.
+  bool next();
+
+  /// Copies up to `size` bytes of the document; returns 0 at the end.
+  std::size_t read(void* buf, std::size_t size);
+
+  /// Writes the whole document to `os`.
+  void write(std::ostream& os);
+}; // TaskDataWriter
+
+void TaskDataWriter::writeHeader() {
+  namespace ra = isoxml::root_attr;
+  const auto& db = _db;
+  _xml.declaration("1.0", "utf-8");
+  _xml.start(isoxml::Root);
+  for (const auto& [k, v]: db.otherAttr)
+    _xml.attr(k, v);
+  _xml.attr(ra::VersionMajor, db.versionMajor);
+  _xml.attr(ra::VersionMinor, db.versionMinor);
+  _xml.attr(ra::MgmtSoftwareManufacturer, db.swVendor);
+  _xml.attr(ra::MgmtSoftwareVersion, db.swVersion);
+  if (db.dataTransferOrigin != -1)
+    _xml.attr(ra::DataTransferOrigin, db.dataTransferOrigin);
+} // writeHeader
+
+void TaskDataWriter::writeValue(std::size_t i) {
   struct Value {
     int offset;
     const char* scale;
     int digits;
     const char* units;
   }; // Value
-  const auto Values = std::array<Value, 9>{{
+  static constexpr auto Values = std::array<Value, 9>{{
     { 0, "0.001", 2, "l"       },
     { 0, "0.001", 2, "kg"      },
     { 0, "0.01" , 2, "l/ha"    },
@@ -816,18 +1171,125 @@ pugi::xml_document CreateDoc(const FarmDb& db) {
     { 0, "1"    , 0, "sds"     },
     { 0, "1"    , 0, "°"       }
   }}; // Values
-  for (int i = 0; i != std::ssize(Values); ++i) {
-    const auto& value = Values[i];
-    auto vpn = root.append_child("VPN");
-    vpn.append_attribute("A") = "VPN" + std::to_string(i+1);
-    vpn.append_attribute("B") = value.offset;
-    vpn.append_attribute("C") = value.scale;
-    vpn.append_attribute("D") = value.digits;
-    vpn.append_attribute("E") = value.units;
+  if (i >= Values.size()) {
+    _stage = Stage::Trailer;
+    return;
   }
-
-  return doc;
-} // CreateDoc
+  const auto& value = Values[i];
+  _xml.start("VPN");
+  _xml.attr("A", "VPN" + std::to_string(i+1));
+  _xml.attr("B", value.offset);
+  _xml.attr("C", value.scale);
+  _xml.attr("D", value.digits);
+  _xml.attr("E", value.units);
+  _xml.end();
+  ++_i;
+} // writeValue
+
+bool TaskDataWriter::next() {
+  const auto& db = _db;
+  switch (_stage) {
+    case Stage::Header:
+      writeHeader();
+      _stage = Stage::Customers;
+      _i = 0;
+      return true;
+    case Stage::Customers:
+      if (_i != db.customers.size()) {
+        WriteCustomer(_xml, *db.customers[_i], static_cast<int>(_i+1));
+        ++_i;
+        return true;
+      }
+      _stage = Stage::Farms;
+      _i = 0;
+      [[fallthrough]];
+    case Stage::Farms:
+      if (_i != db.farms.size()) {
+        const auto& farm = *db.farms[_i];
+        WriteFarm(_xml, farm, static_cast<int>(_i+1),
+                  findCustId(farm.customer));
+        ++_i;
+        return true;
+      }
+      _stage = Stage::FieldStart;
+      _i = 0;
+      [[fallthrough]];
+    case Stage::FieldStart:
+      if (_i == db.fields.size()) {
+        _stage = Stage::Values;
+        _i = 0;
+        return next();
+      } else {
+        const auto& field = *db.fields[_i];
+        WriteFieldStart(_xml, field, static_cast<int>(_i+1),
+                        findCustId(field.customer), findFarmId(field.farm));
+        _stage = Stage::Parts;
+        _j = 0;
+        return true;
+      }
+    case Stage::Parts: {
+      const auto& field = *db.fields[_i];
+      if (_j != field.parts.size()) {
+        WriteBoundary(_xml, field.parts[_j++]);
+        return true;
+      }
+      _stage = Stage::Swaths;
+      _j = 0;
+      [[fallthrough]];
+    }
+    case Stage::Swaths: {
+      const auto& field = *db.fields[_i];
+      if (_j != field.swaths.size()) {
+        WriteSwath(_xml, field.swaths[_j++], ++_swathId);
+        return true;
+      }
+      _stage = Stage::FieldEnd;
+      [[fallthrough]];
+    }
+    case Stage::FieldEnd:
+      _xml.end(); // PFD
+      _stage = Stage::FieldStart;
+      ++_i;
+      return true;
+    case Stage::Values:
+      writeValue(_i);
+      if (_stage == Stage::Values)
+        return true;
+      [[fallthrough]];
+    case Stage::Trailer:
+      _xml.end(); // root
+      _stage = Stage::Done;
+      return true;
+    case Stage::Done:
+      break;
+  }
+  return false;
+} // next
+
+std::size_t TaskDataWriter::read(void* buf, std::size_t size) {
+  while (_pos == _xml.size()) {
+    _xml.clear();
+    _pos = 0;
+    if (!next())
+      return 0;
+  }
+  const auto n = std::min(size, _xml.size() - _pos);
+  std::memcpy(buf, _xml.data() + _pos, n);
+  _pos += n;
+  return n;
+} // read
+
+void TaskDataWriter::write(std::ostream& os) {
+  auto flush = [&] {
+    os.write(_xml.data(), static_cast<std::streamsize>(_xml.size()));
+    _xml.clear();
+  };
+  while (next()) {
+    if (_xml.size() >= FlushSize)
+      flush();
+  }
+  flush();
+} // write
 
 } // local
 
@@ -838,8 +1300,13 @@ void FarmDb::writeXml(const fs::path& output) const {
              + output.string();
     throw std::runtime_error{msg};
   }
-  auto doc = CreateDoc(*this);
-  if (!doc.save_file(output.c_str(), "  ")) {
+  auto writer = TaskDataWriter{*this};
+  auto os = std::ofstream{output, std::ios::binary};
+  if (os)
+    writer.write(os);
+  if (os)
+    os.close();
+  if (!os) {
     auto msg =std::string{"error writing '"} + output.string() + "'";
     throw std::runtime_error{"FarmDb::writeXml:" + msg};
   }
@@ -847,28 +1314,140 @@ void FarmDb::writeXml(const fs::path& output) const {
 
 namespace {
 
-void WriteZip(const fs::path& zipPath, const std::string& xml) {
-  constexpr auto name = "TASKDATA/TASKDATA.XML";
-  auto zip  = ZipArchive{zipPath, ZIP_CREATE | ZIP_TRUNCATE};
-  auto src  = zip.source(xml);
-  (void) zip.addFile(name, src, ZIP_FL_OVERWRITE);
-  zip.close();
-} // WriteZip
+using Compression = ZipOptions::Compression;
 
+int DeflateLevel(Compression c) noexcept {
+  switch (c) {
+    case Compression::Fast: return 1;
+    case Compression::Best: return 9;
+    default:                return 6;
+  }
+} // DeflateLevel
+
+// The libzip method for the entries that libzip compresses itself.
+zip_int32_t ZipMethod(Compression c) {
+  if (c == Compression::Store)
+    return ZIP_CM_STORE;
+  if (c != Compression::Zstd)
+    return ZIP_CM_DEFLATE;
+#ifdef ZIP_CM_ZSTD
+  if (ZipArchive::CompressionSupported(ZIP_CM_ZSTD))
+    return ZIP_CM_ZSTD;
+#endif
+  throw std::runtime_error{"FarmDb::writeZip: libzip lacks zstd support"};
+} // ZipMethod
+
+// Adds the entries of one archive.  Every entry is pulled through its
+// reader, in order, while close() writes the archive, so none is ever
+// held whole.  On one thread libzip compresses each entry itself; on
+// several, deflated entries are compressed here a round of blocks at a
+// time, as libzip takes them, and copied by libzip as they are.
+class ZipEntries {
+  ZipArchive& _zip;
+  const ZipOptions& _options;
+  std::deque<tjg::DeflateStream> _streams;  // stable: the sources use them
+  std::exception_ptr _error;                // the first reader exception
+
+  // An exception from `read` surfaces from close() as a zip error.
+  tjg::DeflateReadFn guarded(tjg::DeflateReadFn read) {
+    return [this, read = std::move(read)](void* buf, std::size_t size) {
+      try {
+        return read(buf, size);
+      }
+      catch (...) {
+        if (!_error)
+          _error = std::current_exception();
+        throw;
+      }
+    };
+  } // guarded
+
+public:
+  ZipEntries(ZipArchive& zip, const ZipOptions& options)
+    : _zip{zip}, _options{options} { }
+
+  void add(const fs::path& name, tjg::DeflateReadFn read);
+  void close();
+}; // ZipEntries
+
+void ZipEntries::add(const fs::path& name, tjg::DeflateReadFn read) {
+  const auto c = _options.compression;
+  if (c == Compression::Store || c == Compression::Zstd
+      || tjg::ThreadCount(_options.threads) <= 1)
+  {
+    auto src = _zip.source(guarded(std::move(read)));
+    auto file = _zip.addFile(name, src, ZIP_FL_OVERWRITE);
+    if (c == Compression::Store || c == Compression::Zstd)
+      file.setCompression(ZipMethod(c));
+    else
+      file.setCompression(ZIP_CM_DEFLATE,
+                          static_cast<zip_uint32_t>(DeflateLevel(c)));
+    return;
+  }
+  auto& stream = _streams.emplace_back(guarded(std::move(read)),
+                                       DeflateLevel(c), _options.threads);
+  auto src = _zip.deflated(
+      [&stream](void* buf, std::size_t size)
+        { return stream.read(buf, size); },
+      [&stream] {
+        return ZipArchive::DeflatedStat{stream.size(), stream.crc()};
+      });
+  (void) _zip.addFile(name, src, ZIP_FL_OVERWRITE);
+} // add
+
+void ZipEntries::close() {
+  try {
+    _zip.close();
+  }
+  catch (...) {
+    if (_error)
+      std::rethrow_exception(_error);
+    throw;
+  }
+} // close
+
+void WriteZip(const fs::path& zipPath, const FarmDb& db,
+              const ZipOptions& options)
+{
+  const auto c = options.compression;
+  if (c == Compression::Store || c == Compression::Zstd)
+    (void) ZipMethod(c);  // before truncating the file
+  auto xml = TaskDataWriter{db};
+  auto wkt = std::optional<WktWriter>{};
+  auto fdb = std::optional<FdbStream>{};
+  auto zip = ZipArchive{zipPath, ZIP_CREATE | ZIP_TRUNCATE};
+  auto entries = ZipEntries{zip, options};
+  entries.add("TASKDATA/TASKDATA.XML",
+              [&](void* buf, std::size_t size) { return xml.read(buf, size); });
+  if (options.wkt) {
+    wkt.emplace(db, options.wktOptions);
+    entries.add("TASKDATA/TASKDATA.wkt",
+                [&](void* buf, std::size_t size) {
+                  return wkt->read(buf, size);
+                });
+  }
+  if (options.fdb) {
+    fdb.emplace(db);
+    entries.add("TASKDATA/TASKDATA.fdb",
+                [&](void* buf, std::size_t size) {
+                  return fdb->read(buf, size);
+                });
+  }
+  entries.close();
+} // WriteZip
 
 } // local
 
-void FarmDb::writeZip(const fs::path& output) const {
+void FarmDb::writeZip(const fs::path& output,
+                      const ZipOptions& options) const
+{
   auto ext = output.extension();
   if (ext != ".zip") {
     auto msg = std::string{"FarmDb::writeZip: invalid filename extension: "}
              + output.string();
     throw std::runtime_error{msg};
   }
-  auto doc = CreateDoc(*this);
-  auto os = std::ostringstream{};
-  doc.save(os, "  ");
-  WriteZip(output, os.str());
+  WriteZip(output, *this, options);
 } // writeZip
 
 } // farm_db
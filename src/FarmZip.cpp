@@ -1,21 +1,21 @@
 /// @file
-/// Reads a zipped ESRI Shapefile set by extracting to a temp directory and
-/// then calling FarmDb::ReadShp(temp_shp_path).
+/// Reads a zipped ISOXML TASKDATA or ESRI Shapefile set, and writes a zipped
+/// shapefile set.  Nothing is written to disk: TASKDATA.XML is parsed as it
+/// is decompressed, and the shapefile set is decompressed into memory and
+/// read through shapelib hooks, or built in memory and compressed.
 
 #include "FarmDb.hpp"
+#include "FarmShp.hpp"
+#include "XmlReader.hpp"
 #include "ZipArchive.hpp"
 
 #include <array>
 #include <cstddef>
-#include <cstdint>
 #include <filesystem>
-#include <fstream>
-#include <random>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -25,69 +25,29 @@ namespace {
 
 namespace fs = std::filesystem;
 
-struct TempDir {
-  fs::path path;
-
-  explicit TempDir(const fs::path& base) : path{base} { }
-
-  TempDir(const TempDir&) = delete;
-  TempDir& operator=(const TempDir&) = delete;
-
-  TempDir(TempDir&&) = delete;
-  TempDir& operator=(TempDir&&) = delete;
-
-  ~TempDir() noexcept {
-    std::error_code ec;
-    if (!path.empty())
-      fs::remove_all(path, ec);
-  }
-}; // TempDir
-
-[[nodiscard]] fs::path MakeUniqueTempDir() {
-  auto base = fs::temp_directory_path();
-
-  std::random_device rd;
-  std::uint64_t r1 = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
-  std::uint64_t r2 = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
-
-  std::ostringstream oss;
-  oss << "farmdb_shp_" << std::hex << r1 << "_" << r2;
-
-  auto dir = base / oss.str();
-  fs::create_directories(dir);
-  return dir;
-} // MakeUniqueTempDir
-
 [[noreturn]] void ThrowZipError( const fs::path& path, const std::string& msg) {
   std::ostringstream oss;
   oss << path.generic_string() << ": " << msg;
   throw std::runtime_error{oss.str()};
 } // ThrowZipError
 
-void ExtractEntryToFile(ZipArchive::File file, const fs::path& outPath) {
-  auto out = std::ofstream{outPath, std::ios::binary};
-  if (!out) {
-    ThrowZipError(file.fullName(),
-                  "failed to create file: " + outPath.generic_string());
-  }
+std::vector<char> ReadEntry(ZipArchive::File file) {
+  auto buf = std::vector<char>(file.size());
   file.open();
-  auto buf = std::array<char, 8 * 1024>{};
-  for (;;) {
-    const auto n = file.read(buf.data(), buf.size());
-    if (n == 0)
-      break;
-    out.write(buf.data(), static_cast<std::streamsize>(n));
-    if (!out) {
-      ThrowZipError(file.fullName().generic_string(),
-                    "write failed: " + outPath.string());
-    }
+  auto n = std::size_t{0};
+  while (n != buf.size()) {
+    const auto k = file.read(buf.data() + n, buf.size() - n);
+    if (k == 0)
+      ThrowZipError(file.fullName(), "entry shorter than its stated size");
+    n += k;
   }
   file.close();
-} // ExtractEntryToFile
+  return buf;
+} // ReadEntry
 
 } // local
 
-FarmDb FarmDb::ReadZip(const std::filesystem::path& zipPath) {
+FarmDb FarmDb::ReadZip(const std::filesystem::path& zipPath, int threads) {
   static const auto TaskDataName = fs::path{"TASKDATA/TASKDATA.XML"};
 
   if (zipPath.extension() != ".zip")
@@ -97,18 +57,20 @@ FarmDb FarmDb::ReadZip(const std::filesystem::path& zipPath) {
 
   auto taskIdx = zip.file(TaskDataName);
   if (taskIdx) {
-    const auto tmpPath = MakeUniqueTempDir();
-    auto tmp = TempDir{tmpPath};
-    const auto outfile  = tmpPath / TaskDataName.filename();
     taskIdx.open();
-    ExtractEntryToFile(taskIdx, outfile);
-    return ReadXml(outfile);
+    auto xml = tjg::XmlReader{
+        [&taskIdx](char* buf, std::size_t size)
+          { return taskIdx.read(buf, size); },
+        taskIdx.fullName().generic_string()};
+    auto db = ReadXml(xml);
+    taskIdx.close();
+    return db;
   }
 
   auto numEntries = zip.numEntries();
   if (numEntries < 3)
     ThrowZipError(zipPath, "zip contains too few entries");
-  if (numEntries > 8)
+  if (numEntries > 16)
     ThrowZipError(zipPath, "zip contains too many entries");
 
   auto pathShp = fs::path{};
@@ -129,43 +91,49 @@ FarmDb FarmDb::ReadZip(const std::filesystem::path& zipPath) {
 
   auto pathShx = fs::path{pathShp}.replace_extension(".shx");
   auto pathDbf = fs::path{pathShp}.replace_extension(".dbf");
-  auto pathPrj = fs::path{pathShp}.replace_extension(".prj");
   auto pathCpg = fs::path{pathShp}.replace_extension(".cpg");
 
   auto shxIdx  = zip.file(pathShx);
   auto dbfIdx  = zip.file(pathDbf);
-  auto prjIdx  = zip.file(pathPrj);
   auto cpgIdx  = zip.file(pathCpg);
 
   if (!shxIdx || !dbfIdx)
     ThrowZipError(zipPath, "cannot find .shx and .dbf files");
 
-  const auto tmpPath = MakeUniqueTempDir();
-  auto tmp = TempDir{tmpPath};
-
-  const auto stem   = pathShp.stem();
-  const auto base   = tmpPath / stem;
-  const auto outShp = fs::path{base}.replace_extension(".shp");
-  const auto outShx = fs::path{base}.replace_extension(".shx");
-  const auto outDbf = fs::path{base}.replace_extension(".dbf");
+  auto files = ShpBuffers{};
+  files.path = zipPath / pathShp;
+  files.shp  = ReadEntry(shpIdx);
+  files.shx  = ReadEntry(shxIdx);
+  files.dbf  = ReadEntry(dbfIdx);
+  if (cpgIdx)
+    files.cpg = ReadEntry(cpgIdx);
 
-  ExtractEntryToFile(shpIdx, outShp);
-  ExtractEntryToFile(shxIdx, outShx);
-  ExtractEntryToFile(dbfIdx, outDbf);
-  ExtractEntryToFile(dbfIdx, outDbf);
-  ExtractEntryToFile(dbfIdx, outDbf);
-
-  if (prjIdx) {
-    const auto outPrj = fs::path{base}.replace_extension(".prj");
-    ExtractEntryToFile(prjIdx, outPrj);
-  }
+  return farm_db::ReadShp(files, threads);
+} // FarmDb::ReadZip
 
-  if (cpgIdx) {
-    const auto outCpg = fs::path{base}.replace_extension(".cpg");
-    ExtractEntryToFile(cpgIdx, outCpg);
+void FarmDb::writeShpZip(const fs::path& zipPath) const {
+  if (zipPath.extension() != ".zip" || zipPath.stem().extension() != ".shp")
+    ThrowZipError(zipPath, "FarmDb::writeShpZip: expected a .shp.zip file");
+
+  const auto shpName = zipPath.stem();
+  const auto sets = std::array{BoundaryShp(*this, shpName),
+                               SwathShp(*this, SwathShpPath(shpName))};
+
+  auto zip = ZipArchive{zipPath, ZIP_CREATE | ZIP_TRUNCATE};
+  auto add = [&zip](fs::path name, const std::vector<char>& data) {
+    auto src = zip.source(std::string_view{data.data(), data.size()});
+    (void) zip.addFile(name, src, ZIP_FL_OVERWRITE);
+  };
+  // The buffers outlive close(), which is when libzip reads them.
+  for (const auto& files: sets) {
+    auto name = files.path;
+    add(name, files.shp);
+    add(name.replace_extension(".shx"), files.shx);
+    add(name.replace_extension(".dbf"), files.dbf);
+    if (!files.cpg.empty())
+      add(name.replace_extension(".cpg"), files.cpg);
   }
-
-  return FarmDb::ReadShp(outShp);
-} // FarmDb::ReadZip
+  zip.close();
+} // FarmDb::writeShpZip
 
 } // farm_db
@@ -0,0 +1,181 @@
+/// @file
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+#include "FieldIndex.hpp"
+
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/algorithms/covered_by.hpp>
+#include <boost/geometry/algorithms/distance.hpp>
+#include <boost/geometry/algorithms/envelope.hpp>
+#include <boost/geometry/algorithms/relate.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+namespace farm_db {
+
+namespace {
+
+namespace bgi = boost::geometry::index;
+
+using GeoBox = ggl::model::box<LatLon>;
+using Value  = std::pair<GeoBox, std::size_t>; // index into Impl::refs
+using Tree   = bgi::rtree<Value, bgi::rstar<16>>;
+
+// The interiors meet: touching along a boundary is not an overlap.
+template<class A, class B>
+bool InteriorsMeet(const A& a, const B& b) {
+  static const auto mask = ggl::de9im::mask{"T********"};
+  return ggl::relate(a, b, mask);
+} // InteriorsMeet
+
+struct AnyPart {
+  constexpr bool operator()(const FieldIndex::PartRef&) const noexcept
+    { return true; }
+}; // AnyPart
+
+} // local
+
+struct FieldIndex::Impl {
+  const FarmDb& db;
+  std::vector<PartRef> refs;  // in field, then part, order
+  Tree tree;
+
+  Impl(const FarmDb& db_, std::vector<PartRef> refs_,
+       const std::vector<Value>& values)
+    : db{db_}, refs{std::move(refs_)}, tree{values} { }  // packed in bulk
+
+  const geo::Polygon& part(const PartRef& r) const
+    { return db.fields[r.field]->parts[r.part]; }
+
+  // Parts that `keep` accepts, whose envelopes meet that of `geom` and
+  // that pass `test`, in index order.  `keep` is tried during the tree
+  // search, so it should be the cheap test and `test` the exact one.
+  template<class Geom, class Test, class Keep = AnyPart>
+  std::vector<PartRef> query(const Geom& geom, const Test& test,
+                             const Keep& keep = {}) const
+  {
+    auto hits = std::vector<Value>{};
+    tree.query(bgi::intersects(ggl::return_envelope<GeoBox>(geom))
+                 && bgi::satisfies([&](const Value& v)
+                                     { return keep(refs[v.second]); }),
+               std::back_inserter(hits));
+    std::ranges::sort(hits, {}, &Value::second);
+    auto out = std::vector<PartRef>{};
+    for (const auto& hit: hits) {
+      const auto& ref = refs[hit.second];
+      if (test(part(ref)))
+        out.push_back(ref);
+    }
+    return out;
+  } // query
+}; // Impl
+
+FieldIndex::FieldIndex(const FarmDb& db) {
+  auto refs   = std::vector<PartRef>{};
+  auto values = std::vector<Value>{};
+  for (auto f = std::size_t{0}; f != db.fields.size(); ++f) {
+    const auto& parts = db.fields[f]->parts;
+    for (auto p = std::size_t{0}; p != parts.size(); ++p) {
+      values.emplace_back(ggl::return_envelope<GeoBox>(parts[p]),
+                          refs.size());
+      refs.push_back({f, p});
+    }
+  }
+  _impl = std::make_unique<const Impl>(db, std::move(refs), values);
+} // ctor
+
+FieldIndex::FieldIndex(FieldIndex&&) noexcept = default;
+FieldIndex& FieldIndex::operator=(FieldIndex&&) noexcept = default;
+FieldIndex::~FieldIndex() noexcept = default;
+
+std::size_t FieldIndex::size() const noexcept { return _impl->refs.size(); }
+
+std::vector<FieldIndex::Overlap> FieldIndex::overlaps() const {
+  // Parts of one field never overlap, and each pair is tested once, from
+  // the side of its lower field, before the exact test.
+  const auto& impl = *_impl;
+  auto out = std::vector<Overlap>{};
+  for (const auto& a: impl.refs) {
+    const auto& poly = impl.part(a);
+    const auto hits = impl.query(poly,
+        [&](const geo::Polygon& other) { return InteriorsMeet(poly, other); },
+        [&](const PartRef& b) { return b.field > a.field; });
+    for (const auto& b: hits)
+      out.push_back({a, b});
+  }
+  return out;
+} // overlaps
+
+std::vector<FieldIndex::PartRef>
+FieldIndex::overlapping(const geo::Polygon& poly) const {
+  return _impl->query(poly, [&](const geo::Polygon& part)
+                              { return InteriorsMeet(poly, part); });
+} // overlapping
+
+std::vector<FieldIndex::PartRef>
+FieldIndex::containing(const LatLon& pt) const {
+  return _impl->query(pt, [&](const geo::Polygon& part)
+                            { return ggl::covered_by(pt, part); });
+} // containing
+
+std::vector<FieldIndex::PartRef>
+FieldIndex::containing(const geo::Path& path) const {
+  if (path.empty())
+    return {};
+  return _impl->query(path, [&](const geo::Polygon& part)
+                              { return ggl::covered_by(path, part); });
+} // containing
+
+std::vector<FieldIndex::Crossing> FieldIndex::crossings() const {
+  const auto& impl = *_impl;
+  auto out = std::vector<Crossing>{};
+  const auto& fields = impl.db.fields;
+  for (auto f = std::size_t{0}; f != fields.size(); ++f) {
+    const auto& swaths = fields[f]->swaths;
+    for (auto s = std::size_t{0}; s != swaths.size(); ++s) {
+      const auto& path = swaths[s].path;
+      if (path.size() < 2)
+        continue;
+      const auto hits = impl.query(path, [&](const geo::Polygon& part)
+                                     { return InteriorsMeet(path, part); });
+      for (const auto& into: hits) {
+        if (into.field != f)
+          out.push_back({f, s, into});
+      }
+    }
+  }
+  return out;
+} // crossings
+
+std::optional<FieldIndex::Nearest> FieldIndex::nearest(const LatLon& pt) const
+{
+  // Parts come out in order of their envelopes' distance, which never
+  // exceeds the part's own, so the search stops at the first envelope
+  // farther than the best part so far.
+  const auto& impl = *_impl;
+  const auto& tree = impl.tree;
+  auto best = std::optional<Nearest>{};
+  auto bestM = 0.0;
+  for (auto it = tree.qbegin(bgi::nearest(pt, tree.size()));
+       it != tree.qend(); ++it)
+  {
+    if (best && ggl::distance(pt, it->first) >= bestM)
+      break;
+    const auto& ref = impl.refs[it->second];
+    const auto d = ggl::distance(pt, impl.part(ref));
+    if (!best || d < bestM) {
+      bestM = d;
+      best  = Nearest{ref.field, d * mp_units::si::metre};
+      if (d == 0.0)
+        break;
+    }
+  }
+  return best;
+} // nearest
+
+} // farm_db
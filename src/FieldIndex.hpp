@@ -0,0 +1,84 @@
+/// @file
+/// R-tree over the parts of a FarmDb's fields.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// The envelope of every part of every field is bulk loaded into a
+/// Boost.Geometry rtree, so a query compares a geometry against the few
+/// parts whose envelopes meet it instead of against every part; checking
+/// all pairs of fields for overlap is then O(n log n) rather than O(n^2).
+/// Envelopes and distances are geographic, on the WGS84 spheroid.  Only
+/// candidates that pass the envelope test get the exact, and much slower,
+/// geometric test.  The index refers to the FarmDb's fields by position, so
+/// the FarmDb must outlive it and its fields and parts must not change.
+#pragma once
+#include "FarmGeo.hpp"
+
+#include <compare>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace farm_db {
+
+class FieldIndex {
+public:
+  /// Part `part` of `db.fields[field]`.
+  struct PartRef {
+    std::size_t field = 0;
+    std::size_t part  = 0;
+    auto operator<=>(const PartRef&) const = default;
+  }; // PartRef
+
+  /// Parts of two different fields whose interiors meet; a.field < b.field.
+  struct Overlap {
+    PartRef a;
+    PartRef b;
+  }; // Overlap
+
+  /// Swath `swath` of field `field` runs through the interior of `into`,
+  /// a part of another field.
+  struct Crossing {
+    std::size_t field = 0;
+    std::size_t swath = 0;
+    PartRef into;
+  }; // Crossing
+
+  struct Nearest {
+    std::size_t field = 0;
+    Distance distance;  ///< zero when the point is on the field
+  }; // Nearest
+
+  explicit FieldIndex(const FarmDb& db);
+  FieldIndex(FieldIndex&&) noexcept;
+  FieldIndex& operator=(FieldIndex&&) noexcept;
+  ~FieldIndex() noexcept;
+
+  /// Parts indexed.
+  std::size_t size() const noexcept;
+
+  /// Every overlapping pair, each once, in field order.
+  std::vector<Overlap> overlaps() const;
+
+  /// Parts whose interiors meet that of `poly`.
+  std::vector<PartRef> overlapping(const geo::Polygon& poly) const;
+
+  /// Parts that cover `pt`, boundary included.
+  std::vector<PartRef> containing(const LatLon& pt) const;
+
+  /// Parts that cover the whole of `path`.
+  std::vector<PartRef> containing(const geo::Path& path) const;
+
+  /// Every swath that runs into another field, in field and swath order.
+  std::vector<Crossing> crossings() const;
+
+  /// The field with a part nearest to `pt`; none for an empty index.
+  std::optional<Nearest> nearest(const LatLon& pt) const;
+
+private:
+  struct Impl;
+  std::unique_ptr<const Impl> _impl;
+}; // FieldIndex
+
+} // farm_db
@@ -0,0 +1,257 @@
+/// @file
+/// On-disk cache of inset results.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// The file is a header and then one record per entry: the key, swath
+/// count and check, and for each swath its name length, point count, name
+/// padded to 8 bytes and its points as LatLon stores them: (lat, lon)
+/// doubles, or fixed-point pairs in a FARM_DB_COMPACT_COORDS build, whose
+/// caches carry their own version so that neither build reads the other's.
+/// Like .fdb files it is in the writer's native byte order, which the
+/// header records.
+#include "InsetCache.hpp"
+#include "BoundarySwaths.hpp"
+#include "MappedFile.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace farm_db {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+namespace cache {
+
+constexpr auto Magic     = std::array<char, 8>{
+                              'I','N','S','E','T','C','\0','\x1a'};
+constexpr auto ByteOrder = std::uint32_t{0x01020304};
+constexpr auto Version   = std::uint32_t{CompactCoords ? 0x102 : 2};
+
+struct Header {
+  std::array<char, 8> magic;
+  std::uint32_t byteOrder;
+  std::uint32_t version;
+  std::uint64_t numEntries;
+}; // Header
+
+struct EntryRec { std::uint64_t key; std::uint32_t numSwaths, check; };
+struct SwathRec { std::uint32_t nameLen, reserved; std::uint64_t numPoints; };
+
+static_assert(sizeof(Header) == 24);
+static_assert(std::is_trivially_copyable_v<LatLon>
+              && sizeof(LatLon) == (CompactCoords ? 8 : 16));
+
+constexpr std::size_t Align = 8;
+
+constexpr std::size_t Aligned(std::size_t n) noexcept
+  { return (n + Align - 1) & ~(Align - 1); }
+
+} // cache
+
+// 64-bit FNV-1a, and a CRC-32 of the same bytes to check it.
+class Hasher {
+  std::uint64_t _h = 0xcbf29ce484222325;
+  uLong _crc = crc32(0L, Z_NULL, 0);
+
+public:
+  void bytes(const void* p, std::size_t n) noexcept {
+    const auto* b = static_cast<const unsigned char*>(p);
+    for (auto i = std::size_t{0}; i != n; ++i) {
+      _h ^= b[i];
+      _h *= 0x100000001b3;
+    }
+    _crc = crc32_z(_crc, b, n);
+  } // bytes
+
+  template<class T>
+  requires std::is_trivially_copyable_v<T>
+  void value(const T& x) noexcept { bytes(&x, sizeof(x)); }
+
+  template<class C>
+  void points(const C& pts) noexcept {
+    value(pts.size());
+    bytes(pts.data(), pts.size() * sizeof(LatLon));
+  } // points
+
+  std::uint64_t result() const noexcept { return _h; }
+  std::uint32_t check()  const noexcept
+    { return static_cast<std::uint32_t>(_crc); }
+}; // Hasher
+
+// Walks a mapped cache file; any overrun throws.
+class Cursor {
+  std::span<const std::byte> _bytes;
+  std::size_t _pos = 0;
+
+public:
+  explicit Cursor(std::span<const std::byte> bytes) : _bytes{bytes} { }
+
+  const std::byte* take(std::size_t n) {
+    if (n > _bytes.size() - _pos)
+      throw std::runtime_error{"truncated"};
+    const auto* p = _bytes.data() + _pos;
+    _pos += cache::Aligned(n);
+    _pos = std::min(_pos, _bytes.size());
+    return p;
+  } // take
+
+  template<class T>
+  T rec() {
+    auto r = T{};
+    std::memcpy(&r, take(sizeof(T)), sizeof(T));
+    return r;
+  } // rec
+}; // Cursor
+
+} // local
+
+InsetCache::InsetCache(fs::path path) : _path{std::move(path)} {
+  try {
+    load();
+  } catch (const std::exception&) {
+    _entries.clear();
+  }
+} // ctor
+
+void InsetCache::load() {
+  auto ec = std::error_code{};
+  if (!fs::exists(_path, ec))
+    return;
+  const auto file = tjg::MappedFile{_path};
+  auto cur = Cursor{file.bytes()};
+  const auto hdr = cur.rec<cache::Header>();
+  if (hdr.magic != cache::Magic || hdr.byteOrder != cache::ByteOrder
+      || hdr.version != cache::Version)
+    return;
+  for (auto e = std::uint64_t{0}; e != hdr.numEntries; ++e) {
+    const auto er = cur.rec<cache::EntryRec>();
+    auto entry = Entry{};
+    entry.check = er.check;
+    entry.swaths.reserve(er.numSwaths);
+    for (auto s = std::uint32_t{0}; s != er.numSwaths; ++s) {
+      const auto sr = cur.rec<cache::SwathRec>();
+      const auto* name = reinterpret_cast<const char*>(cur.take(sr.nameLen));
+      auto& swath = entry.swaths.emplace_back(std::string_view{name,
+                                                              sr.nameLen});
+      if (sr.numPoints > file.size() / sizeof(LatLon))
+        throw std::runtime_error{"truncated"};
+      const auto bytes = sr.numPoints * sizeof(LatLon);
+      const auto* pts = cur.take(bytes);
+      swath.path.resize(sr.numPoints);
+      std::memcpy(swath.path.data(), pts, bytes);
+    }
+    _entries.insert_or_assign(er.key, std::move(entry));
+  }
+} // load
+
+InsetCache::EntryKey InsetCache::Key(const Field& field,
+                                     const std::string& insetName,
+                                     std::span<const Distance> dists,
+                                     const InsetOptions& options)
+{
+  static constexpr auto metre = mp_units::si::metre;
+  auto h = Hasher{};
+  for (auto x: InsetTuning())
+    h.value(x);
+  h.value(DefaultSimplifyTol.numerical_value_in(metre));
+  h.value(options.style);
+  h.value(options.plane);
+  h.value(options.join.index());
+  std::visit([&](const auto& join) { h.value(join); }, options.join);
+  h.value(insetName.size());
+  h.bytes(insetName.data(), insetName.size());
+  h.value(dists.size());
+  for (auto d: dists)
+    h.value(d.numerical_value_in(metre));
+  h.value(field.parts.size());
+  for (const auto& part: field.parts) {
+    h.value(part.inners().size());
+    h.points(part.outer());
+    for (const auto& ring: part.inners())
+      h.points(ring);
+  }
+  return {h.result(), h.check()};
+} // Key
+
+bool InsetCache::find(const EntryKey& key, std::vector<Swath>& swaths) {
+  auto it = _entries.find(key.hash);
+  if (it == _entries.end() || it->second.check != key.check) {
+    ++_misses;
+    return false;
+  }
+  ++_hits;
+  it->second.used = true;
+  swaths = it->second.swaths;
+  return true;
+} // find
+
+void InsetCache::store(const EntryKey& key, const std::vector<Swath>& swaths)
+{
+  auto entry = Entry{};
+  entry.check = key.check;
+  entry.used = true;
+  entry.swaths.reserve(swaths.size());
+  for (const auto& s: swaths)
+    entry.swaths.emplace_back(s.name).path = s.path;
+  _entries.insert_or_assign(key.hash, std::move(entry));
+} // store
+
+void InsetCache::save() const {
+  auto numEntries = std::uint64_t{0};
+  for (const auto& [key, entry]: _entries)
+    numEntries += entry.used;
+
+  // Written beside the old file and renamed over it, so an interrupted run
+  // leaves the previous cache intact.
+  auto tmp = _path;
+  tmp += ".tmp";
+  auto os = std::ofstream{tmp, std::ios::binary};
+  auto put = [&](const void* p, std::size_t n) {
+    static constexpr auto zeros = std::array<char, cache::Align>{};
+    os.write(static_cast<const char*>(p), static_cast<std::streamsize>(n));
+    os.write(zeros.data(),
+             static_cast<std::streamsize>(cache::Aligned(n) - n));
+  };
+  const auto hdr = cache::Header{cache::Magic, cache::ByteOrder,
+                                 cache::Version, numEntries};
+  put(&hdr, sizeof(hdr));
+  for (const auto& [key, entry]: _entries) {
+    if (!entry.used)
+      continue;
+    const auto er = cache::EntryRec{
+        key, static_cast<std::uint32_t>(entry.swaths.size()), entry.check};
+    put(&er, sizeof(er));
+    for (const auto& s: entry.swaths) {
+      const auto sr = cache::SwathRec{
+          static_cast<std::uint32_t>(s.name.size()), 0, s.path.size()};
+      put(&sr, sizeof(sr));
+      put(s.name.data(), s.name.size());
+      put(s.path.data(), s.path.size() * sizeof(LatLon));
+    }
+  }
+  if (os)
+    os.close();
+  if (!os)
+    throw std::runtime_error{tmp.string() + ": error writing inset cache"};
+  fs::rename(tmp, _path);
+} // save
+
+} // farm_db
@@ -0,0 +1,69 @@
+/// @file
+/// On-disk cache of inset results, keyed on each field's geometry.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// A key hashes everything that decides a field's inset swaths: its parts,
+/// the inset name and distances, the InsetOptions, DefaultSimplifyTol and
+/// the tuning constants of BoundarySwaths.  A field whose key is found
+/// takes the cached swaths and is not projected or buffered at all.  The
+/// key is a 64-bit FNV-1a of all that, and an entry is used only if a
+/// CRC-32 of the same bytes matches as well, so a collision of the one
+/// hash cannot hand a field another field's swaths.
+#pragma once
+#include "FarmDb.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace farm_db {
+
+class InsetCache {
+public:
+  struct EntryKey {
+    std::uint64_t hash  = 0;  ///< files the entry
+    std::uint32_t check = 0;  ///< must match too
+  }; // EntryKey
+
+private:
+  struct Entry {
+    std::vector<Swath> swaths;
+    std::uint32_t check = 0;
+    bool used = false;
+  }; // Entry
+
+  std::filesystem::path _path;
+  std::unordered_map<std::uint64_t, Entry> _entries;
+  std::size_t _hits   = 0;
+  std::size_t _misses = 0;
+
+  void load();
+
+public:
+  /// Loads `path` if it exists.  A missing, stale or damaged file leaves
+  /// the cache empty; the cache never makes an inset fail.
+  explicit InsetCache(std::filesystem::path path);
+
+  static EntryKey Key(const Field& field, const std::string& insetName,
+                      std::span<const Distance> dists,
+                      const InsetOptions& options);
+
+  /// Replaces `swaths` with the entry for `key`, if there is one.
+  bool find(const EntryKey& key, std::vector<Swath>& swaths);
+
+  /// Only the names and paths of `swaths` are kept; inset sets nothing else.
+  void store(const EntryKey& key, const std::vector<Swath>& swaths);
+
+  /// Rewrites the file with the entries found or stored since loading, so
+  /// results for fields no longer exported are dropped.
+  void save() const;
+
+  std::size_t hits()   const noexcept { return _hits;   }
+  std::size_t misses() const noexcept { return _misses; }
+}; // InsetCache
+
+} // farm_db
@@ -1,18 +1,33 @@
 #include "FarmDb.hpp"
+#include "FieldIndex.hpp"
+#include "InsetCache.hpp"
+#include "parallel.hpp"
+#include "Stats.hpp"
+#include "TaskDataIndex.hpp"
 
 #include <boost/program_options.hpp>
 
 #include <mp-units/systems/yard_pound.h>
 
 #include <filesystem>
+#include <fstream>
 #include <string>
+#include <string_view>
 #include <optional>
+#include <vector>
+#include <set>
+#include <sstream>
+#include <mutex>
+#include <algorithm>
+#include <chrono>
+#include <span>
 #include <stdexcept>
 #include <exception>
 #include <iostream>
 #include <iomanip>
 #include <format>
 #include <cstdlib>
+#include <cstddef>
 
 namespace po = boost::program_options;
 namespace fs = std::filesystem;
@@ -20,10 +35,96 @@ namespace fs = std::filesystem;
 struct Options {
   fs::path inputPath = "TASKDATA.XML";
   fs::path outputPath;
-  double insetFt = 0.0;
+  std::vector<double> insetFt;
   std::string insetName;
+  int threads = 1;
+  fs::path batchPath;
+  int jobs = 1;
+  fs::path statsPath;
+  bool edges = false;
+  bool cache = false;
+  bool miter = false;
+  bool tangent = false;
+  int arcPoints = farm_db::RoundJoin{}.points;
+  int wktPrecision = farm_db::WktOptions{}.precision;
+  std::string zipCompression = "default";
+  farm_db::ZipOptions::Compression compression =
+      farm_db::ZipOptions{}.compression;
+  bool zipWkt = false;
+  bool zipFdb = false;
+  std::vector<std::string> fieldKeys;
+  bool serve = false;
+  bool check = false;
+  bool trusted = false;
 }; // Options
 
+bool IsInputExt(const fs::path& path) {
+  const auto ext = path.extension();
+  return ext == ".xml" || ext == ".XML" || ext == ".shp" || ext == ".zip"
+      || ext == ".fdb";
+} // IsInputExt
+
+// What --field can select from: an ISOXML TASKDATA file, bare or zipped.
+bool IsIsoXmlInput(const fs::path& path) {
+  const auto ext = path.extension();
+  return ext == ".xml" || ext == ".XML"
+      || (ext == ".zip" && path.stem().extension() != ".shp");
+} // IsIsoXmlInput
+
+bool IsOutputExt(const fs::path& path) {
+  const auto ext = path.extension();
+  return ext == ".xml" || ext == ".wkt" || ext == ".zip" || ext == ".fdb"
+      || ext == ".shp" || (ext == ".gz" && path.stem().extension() == ".wkt");
+} // IsOutputExt
+
+std::optional<farm_db::ZipOptions::Compression>
+ParseCompression(std::string_view s) noexcept {
+  using C = farm_db::ZipOptions::Compression;
+  if (s == "store")   return C::Store;
+  if (s == "fast")    return C::Fast;
+  if (s == "default") return C::Default;
+  if (s == "best")    return C::Best;
+  if (s == "zstd")    return C::Zstd;
+  return std::nullopt;
+} // ParseCompression
+
+/// Only the fields named by `keys` (ids or names), through a TaskDataIndex.
+farm_db::FarmDb LoadFields(const fs::path& input,
+                           const std::vector<std::string>& keys)
+{
+  const auto index = farm_db::TaskDataIndex::Scan(input);
+  auto which = std::vector<std::size_t>{};
+  which.reserve(keys.size());
+  for (const auto& key: keys) {
+    const auto i = index.find(key);
+    if (!i)
+      throw std::runtime_error{input.string() + ": no field " + key};
+    which.push_back(*i);
+  }
+  return index.load(which);
+} // LoadFields
+
+/// Replaces "{stem}" and "{name}" in `pattern` with the stem and file name
+/// of `input`.
+fs::path BatchOutput(const std::string& pattern, const fs::path& input) {
+  auto out = std::string{};
+  const auto stem = input.stem().string();
+  const auto name = input.filename().string();
+  for (auto i = std::size_t{0}; i != pattern.size(); ) {
+    const auto rest = std::string_view{pattern}.substr(i);
+    if (rest.starts_with("{stem}")) {
+      out += stem;
+      i += 6;
+    } else if (rest.starts_with("{name}")) {
+      out += name;
+      i += 6;
+    } else {
+      out += pattern[i++];
+    }
+  }
+  return out;
+} // BatchOutput
+
 std::optional<Options> ParseArgs(int argc, const char* argv[]) {
   auto opts = Options{};
 
@@ -33,12 +134,71 @@ std::optional<Options> ParseArgs(int argc, const char* argv[]) {
     ("input,i",
       po::value<fs::path>(&opts.inputPath)->default_value("TASKDATA.XML"),
       "Input ISO11783 file (default: TASKDATA.XML).")
-    ("inset,d", po::value<double>(&opts.insetFt)->required(),
-      "Inset distance in feet (required).")
+    ("inset,d", po::value<std::vector<double>>(&opts.insetFt),
+      "Inset distance in feet (required except with --serve).  Repeat for "
+      "several headland passes, in increasing order.")
     ("name,n", po::value<std::string>(&opts.insetName)->default_value("Inset"),
       "Inset name (default: \"Inset\").")
-    ("output,o", po::value<fs::path>(&opts.outputPath)->required(),
-      "Output file path (required).");
+    ("threads,t", po::value<int>(&opts.threads)->default_value(1),
+      "Worker threads for insetting and for decoding shapefiles, 0 for "
+      "one per CPU (default: 1).")
+    ("output,o", po::value<fs::path>(&opts.outputPath),
+      "Output file path (required except with --serve).  With --batch, a "
+      "pattern in which {stem} and {name} stand for each input's stem and "
+      "file name.")
+    ("batch,b", po::value<fs::path>(&opts.batchPath),
+      "Process every input listed in this manifest file, one path per "
+      "line, or every input file in this directory.")
+    ("jobs,j", po::value<int>(&opts.jobs)->default_value(1),
+      "Files processed at once with --batch, 0 for one per CPU "
+      "(default: 1).")
+    ("stats,s", po::value<fs::path>(&opts.statsPath),
+      "Write per-stage times and counters, overall and per field, as JSON "
+      "to this file, or to stdout for \"-\".")
+    ("edges,e", po::bool_switch(&opts.edges),
+      "Split each inset ring at its corners and write one open swath per "
+      "edge instead of one closed swath per ring.")
+    ("cache,c", po::bool_switch(&opts.cache),
+      "Keep inset results in <output>.inset-cache and reuse them for "
+      "fields whose boundaries have not changed since the last run.")
+    ("miter,m", po::bool_switch(&opts.miter),
+      "Keep inset corners sharp instead of rounding them; far fewer "
+      "vertices on rectangular fields.")
+    ("arc-points,a",
+      po::value<int>(&opts.arcPoints)->default_value(opts.arcPoints),
+      "Segments per full circle of a rounded corner (default: 32).")
+    ("tangent-plane,p", po::bool_switch(&opts.tangent),
+      "Inset in each field's local tangent plane instead of an "
+      "azimuthal-equidistant projection: much faster, with lengths off by "
+      "less than 1.3 ppm within 10 km of the field centre.")
+    ("wkt-precision,w",
+      po::value<int>(&opts.wktPrecision)->default_value(opts.wktPrecision),
+      "Significant digits of .wkt coordinates, 0 for the shortest form "
+      "that reads back exactly; at most 17 (default: 15).")
+    ("zip-compression",
+      po::value<std::string>(&opts.zipCompression)
+        ->default_value(opts.zipCompression),
+      "Compression of .zip entries: store, fast, default, best, or zstd "
+      "(if libzip supports it).  Deflate levels compress on --threads "
+      "threads.")
+    ("zip-wkt", po::bool_switch(&opts.zipWkt),
+      "Also write the output as TASKDATA/TASKDATA.wkt in a .zip.")
+    ("zip-fdb", po::bool_switch(&opts.zipFdb),
+      "Also write the output as TASKDATA/TASKDATA.fdb in a .zip.")
+    ("field,f", po::value<std::vector<std::string>>(&opts.fieldKeys),
+      "Load and inset only this field of an .xml or .zip input, by id "
+      "(PFD<n>) or name.  Repeat for several fields.  Only those fields, "
+      "their customers and their farms are parsed.")
+    ("trusted", po::bool_switch(&opts.trusted),
+      "Skip the validity check of the input boundaries; for re-processing "
+      "output of this program.")
+    ("check,k", po::bool_switch(&opts.check),
+      "Report, on stderr, parts of different fields that overlap and "
+      "swaths of the input that run into other fields.")
+    ("serve", po::bool_switch(&opts.serve),
+      "Load the input once, then answer requests on stdin, one per line: "
+      "\"inset <output> <feet>...\" or \"quit\".  Each gets one line on "
+      "stdout, \"ok ...\" or \"error <message>\".");
 
   auto positional = po::positional_options_description{};
   positional.add("inset",  1);
@@ -59,17 +219,29 @@ std::optional<Options> ParseArgs(int argc, const char* argv[]) {
         << "  InsetXml [options] <inset_feet> <output>\n\n"
         << desc
         << "\n\n"
-        << "The input  file extension must be .xml, .shp, or .zip.\n"
-        << "The output file extension must be either .xml, .wkt, or .zip.\n"
+        << "The input  file extension must be .xml, .shp, .zip, or .fdb.\n"
+        << "The output file extension must be .xml, .wkt, .zip, .fdb, or\n"
+        << ".shp.\n"
+        << "A .fdb file is a binary FarmDb cache that loads much faster.\n"
+        << "A .wkt.gz output is a gzip-compressed .wkt.\n"
+        << "A .shp output also writes the swaths to <stem>_swaths.shp, and a\n"
+        << ".shp.zip output holds both shapefile sets.\n"
         << "\n"
         << "Examples:\n"
         << "  InsetXml 12.5 out_TASKDATA.xml\n"
         << "  InsetXml -i TASKDATA.XML 12.5 out_TASKDATA.xml\n"
-        << "  InsetXml --input TASKDATA.XML 12.5 out_TASKDATA.xml\n";
+        << "  InsetXml --input TASKDATA.XML 12.5 out_TASKDATA.xml\n"
+        << "  InsetXml -d 12.5 -d 25 -d 37.5 out_TASKDATA.xml\n"
+        << "  InsetXml -b archives/ -j 8 12.5 'out/{stem}.zip'\n"
+        << "  InsetXml -i TASKDATA.XML -p --serve\n";
       return std::nullopt;
     }
 
     po::notify(vm);
+    if (!opts.serve && opts.insetFt.empty())
+      throw po::required_option{"inset"};
+    if (!opts.serve && opts.outputPath.empty())
+      throw po::required_option{"output"};
   }
   catch (const po::error& e) {
     std::cerr << "Command line error: " << e.what() << "\n\n";
@@ -81,70 +253,491 @@ std::optional<Options> ParseArgs(int argc, const char* argv[]) {
     std::exit(2);
   }
 
-  if (opts.insetFt <= 0.5) {
-    std::cerr << "Error: inset distance must be > 0.5 ft.\n";
+  for (auto i = std::size_t{0}; i != opts.insetFt.size(); ++i) {
+    if (opts.insetFt[i] <= 0.5) {
+      std::cerr << "Error: inset distance must be > 0.5 ft.\n";
+      std::exit(2);
+    }
+    if (i != 0 && opts.insetFt[i] <= opts.insetFt[i-1]) {
+      std::cerr << "Error: inset distances must be increasing.\n";
+      std::exit(2);
+    }
+  }
+
+  if (opts.threads < 0) {
+    std::cerr << "Error: thread count must be >= 0.\n";
+    std::exit(2);
+  }
+
+  if (opts.arcPoints < 4) {
+    std::cerr << "Error: --arc-points must be at least 4.\n";
+    std::exit(2);
+  }
+
+  if (opts.wktPrecision < 0 || opts.wktPrecision > 17) {
+    std::cerr << "Error: --wkt-precision must be from 0 to 17.\n";
+    std::exit(2);
+  }
+
+  if (auto c = ParseCompression(opts.zipCompression))
+    opts.compression = *c;
+  else {
+    std::cerr << "Error: --zip-compression must be store, fast, default, "
+                 "best, or zstd.\n";
+    std::exit(2);
+  }
+
+  if (opts.jobs < 0) {
+    std::cerr << "Error: job count must be >= 0.\n";
+    std::exit(2);
+  }
+
+  if (!opts.fieldKeys.empty() && opts.batchPath.empty()
+      && !IsIsoXmlInput(opts.inputPath))
+  {
+    std::cerr << "Error: --field needs an ISOXML input (.xml, or a .zip of "
+                 "TASKDATA).\n";
     std::exit(2);
   }
 
+  if (opts.serve) {
+    if (!opts.batchPath.empty() || !opts.statsPath.empty()) {
+      std::cerr << "Error: --serve cannot be used with --batch or --stats.\n";
+      std::exit(2);
+    }
+    if (!IsInputExt(opts.inputPath)) {
+      std::cerr
+        << "Error: input file extension must be .xml, .shp, .zip, or .fdb\n";
+      std::exit(2);
+    }
+    return opts;
+  }
+
+  if (!opts.batchPath.empty()) {
+    if (!opts.statsPath.empty()) {
+      std::cerr << "Error: --stats cannot be used with --batch.\n";
+      std::exit(2);
+    }
+    const auto pattern = opts.outputPath.string();
+    if (pattern.find("{stem}") == std::string::npos
+        && pattern.find("{name}") == std::string::npos)
+    {
+      std::cerr << "Error: batch output must contain {stem} or {name}.\n";
+      std::exit(2);
+    }
+    if (!IsOutputExt(opts.outputPath)) {
+      std::cerr
+        << "Error: output file extension must be .xml, .wkt, .zip, .fdb,"
+           " or .shp\n";
+      std::exit(2);
+    }
+    return opts;
+  }
+
   if (opts.outputPath == opts.inputPath) {
     std::cerr << "Error: output file must be different than input file.\n";
     std::exit(2);
   }
 
-  auto ext = opts.inputPath.extension();
-  if (ext != ".xml" && ext != ".XML" && ext != ".shp" && ext != ".zip") {
-    std::cerr << "Error: input file extension must be .xml, .ext, or .zip\n";
+  if (!IsInputExt(opts.inputPath)) {
+    std::cerr
+      << "Error: input file extension must be .xml, .shp, .zip, or .fdb\n";
     std::exit(2);
   }
 
-  ext = opts.outputPath.extension();
-  if (ext != ".xml" && ext != ".wkt" && ext != ".zip") {
-    std::cerr << "Error: output file extension must be .xml, .wkt, or .zip\n";
+  if (!IsOutputExt(opts.outputPath)) {
+    std::cerr
+      << "Error: output file extension must be .xml, .wkt, .zip, .fdb,"
+         " or .shp\n";
     std::exit(2);
   }
 
   return opts;
 } // ParseArgs
 
-int main(int argc, const char* argv[]) {
-  try {
-    std::cout << "InsetXml v0.0 built on " __DATE__ " " __TIME__ << '\n';
+void WriteJsonString(std::ostream& os, std::string_view str) {
+  os << '"';
+  for (auto c: str) {
+    switch (c) {
+      case '"':  os << "\\\""; break;
+      case '\\': os << "\\\\"; break;
+      case '\n': os << "\\n";  break;
+      case '\r': os << "\\r";  break;
+      case '\t': os << "\\t";  break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+          os << std::format("\\u{:04x}", static_cast<int>(c));
+        else
+          os << c;
+    }
+  }
+  os << '"';
+} // WriteJsonString
 
-    const auto opts = ParseArgs(argc, argv);
-    if (!opts)
-      return 1;
+void WriteJsonStats(std::ostream& os, const farm_db::Stats& stats) {
+  using farm_db::Stats;
+  os << "{\"ms\": {";
+  for (auto i = 0; i != Stats::NumStages; ++i) {
+    const auto ms = std::chrono::duration<double, std::milli>(stats.time[i]);
+    os << (i ? ", " : "") << '"' << Name(static_cast<Stats::Stage>(i)) << "\": "
+       << std::format("{:.3f}", ms.count());
+  }
+  os << "}, \"verticesIn\": "       << stats.verticesIn
+     << ", \"verticesOut\": "      << stats.verticesOut
+     << ", \"simplifyCalls\": "    << stats.simplifyCalls
+     << ", \"simplifyHalvings\": " << stats.simplifyHalvings
+     << ", \"validQuick\": "       << stats.validQuick
+     << ", \"validFull\": "        << stats.validFull << '}';
+} // WriteJsonStats
 
-    auto db = farm_db::FarmDb{};
-    {
-      const auto ext = opts->inputPath.extension();
-      if (ext == ".shp")
-        db = farm_db::FarmDb::ReadShp(opts->inputPath);
-      else if (ext == ".zip")
-        db = farm_db::FarmDb::ReadZip(opts->inputPath);
-      else
-        db = farm_db::FarmDb::ReadXml(opts->inputPath);
-    }
+void WriteStats(const fs::path& path, const fs::path& input,
+                const farm_db::FarmDb& db, const farm_db::Stats& total,
+                std::span<const farm_db::Stats> fieldStats)
+{
+  auto file = std::ofstream{};
+  if (path != "-") {
+    file.open(path);
+    if (!file)
+      throw std::runtime_error{"cannot create stats file: " + path.string()};
+  }
+  auto& os = (path == "-") ? std::cout : file;
+  os << "{\n  \"input\": ";
+  WriteJsonString(os, input.string());
+  os << ",\n  \"total\": ";
+  WriteJsonStats(os, total);
+  os << ",\n  \"fields\": [";
+  for (auto f = std::size_t{0}; f != fieldStats.size(); ++f) {
+    const auto& field = *db.fields[f];
+    os << (f ? ",\n" : "\n") << "    {\"name\": ";
+    WriteJsonString(os, field.name);
+    os << ", \"farm\": ";
+    WriteJsonString(os, field.farm ? field.farm->name : std::string{});
+    os << ", \"customer\": ";
+    WriteJsonString(os, field.customer ? field.customer->name : std::string{});
+    os << ", \"parts\": " << field.parts.size() << ", \"stats\": ";
+    WriteJsonStats(os, fieldStats[f]);
+    os << '}';
+  }
+  os << "\n  ]\n}\n";
+  os.flush();
+  if (!os)
+    throw std::runtime_error{"error writing stats: " + path.string()};
+} // WriteStats
+
+farm_db::InsetOptions InsetOptionsOf(const Options& opts) {
+  auto options = farm_db::InsetOptions{};
+  if (opts.edges)
+    options.style = farm_db::InsetStyle::Edges;
+  if (opts.tangent)
+    options.plane = farm_db::PlaneKind::Tangent;
+  if (opts.miter)
+    options.join = farm_db::MiterJoin{};
+  else
+    options.join = farm_db::RoundJoin{opts.arcPoints};
+  options.trusted = opts.trusted;
+  return options;
+} // InsetOptionsOf
+
+farm_db::FarmDb ReadInput(const fs::path& input, const Options& opts) {
+  const auto ext = input.extension();
+  if (!opts.fieldKeys.empty()) {
+    if (!IsIsoXmlInput(input))
+      throw std::runtime_error{input.string() + ": --field needs an ISOXML "
+                               "input"};
+    return LoadFields(input, opts.fieldKeys);
+  }
+  if (ext == ".shp")
+    return farm_db::FarmDb::ReadShp(input, opts.threads);
+  if (ext == ".zip")
+    return farm_db::FarmDb::ReadZip(input, opts.threads);
+  if (ext == ".fdb")
+    return farm_db::FarmDb::ReadFdb(input);
+  return farm_db::FarmDb::ReadXml(input);
+} // ReadInput
 
+void WriteOutput(const farm_db::FarmDb& db, const fs::path& output,
+                 const Options& opts)
+{
+  const auto ext = output.extension();
+  if (ext == ".wkt" || ext == ".gz")
+    db.writeWkt(output, {opts.wktPrecision, opts.threads});
+  else if (ext == ".zip" && output.stem().extension() == ".shp")
+    db.writeShpZip(output);
+  else if (ext == ".zip") {
+    auto zip = farm_db::ZipOptions{};
+    zip.compression = opts.compression;
+    zip.threads     = opts.threads;
+    zip.wkt         = opts.zipWkt;
+    zip.fdb         = opts.zipFdb;
+    zip.wktOptions  = {opts.wktPrecision, opts.threads};
+    db.writeZip(output, zip);
+  }
+  else if (ext == ".shp")
+    db.writeShp(output);
+  else if (ext == ".fdb")
+    db.writeFdb(output);
+  else
+    db.writeXml(output);
+} // WriteOutput
+
+/// Lists the overlapping fields of `db` and its swaths that run into other
+/// fields, found through a FieldIndex.
+void CheckFields(std::ostream& os, const fs::path& input,
+                 const farm_db::FarmDb& db)
+{
+  const auto index = farm_db::FieldIndex{db};
+  const auto& fields = db.fields;
+  for (const auto& o: index.overlaps()) {
+    os << input.string() << ": field "
+       << std::quoted(fields[o.a.field]->name) << " overlaps field "
+       << std::quoted(fields[o.b.field]->name) << '\n';
+  }
+  for (const auto& c: index.crossings()) {
+    const auto& field = *fields[c.field];
+    os << input.string() << ": swath "
+       << std::quoted(field.swaths[c.swath].name) << " of field "
+       << std::quoted(field.name) << " runs into field "
+       << std::quoted(fields[c.into.field]->name) << '\n';
+  }
+} // CheckFields
+
+/// Reads `input`, insets it, and writes `output`.  Returns the field count.
+std::size_t Process(const fs::path& input, const fs::path& output,
+                    const Options& opts, bool verbose)
+{
+  using farm_db::Stats;
+  const auto wantStats = !opts.statsPath.empty();
+  auto total = Stats{};
+  auto fieldStats = std::vector<Stats>{};
+
+  auto db = farm_db::FarmDb{};
+  {
+    auto scope = farm_db::StatsScope{wantStats ? &total : nullptr};
+    auto timer = farm_db::StageTimer{Stats::Parse};
+    db = ReadInput(input, opts);
+  }
+
+  if (verbose) {
     std::cout << db.customers.size() << " customers\n"
               << db.farms.size()     << " farms\n"
               << db.fields.size()    << " fields\n\n";
+  }
+
+  if (opts.check)
+    CheckFields(std::cerr, input, db);
 
 #if 0
-    db.swVendor  = "Terry Golubiewski";
-    db.swVersion = "0.1 (alpha)";
+  db.swVendor  = "Terry Golubiewski";
+  db.swVersion = "0.1 (alpha)";
 #endif
 
-    if (opts->insetFt != 0.0)
-      db.inset(opts->insetName, opts->insetFt * mp_units::yard_pound::foot);
-    {
-      const auto ext = opts->outputPath.extension();
-      if (ext == ".wkt")
-        db.writeWkt(opts->outputPath);
-      else if (ext == ".zip")
-        db.writeZip(opts->outputPath);
-      else
-        db.writeXml(opts->outputPath);
+  if (!opts.insetFt.empty()) {
+    auto dists = std::vector<farm_db::Distance>{};
+    dists.reserve(opts.insetFt.size());
+    for (auto ft: opts.insetFt)
+      dists.push_back(ft * mp_units::yard_pound::foot);
+    auto cache = std::optional<farm_db::InsetCache>{};
+    if (opts.cache) {
+      auto cachePath = output;
+      cachePath += ".inset-cache";
+      cache.emplace(std::move(cachePath));
+    }
+    db.inset(opts.insetName, dists, opts.threads,
+             wantStats ? &fieldStats : nullptr,
+             InsetOptionsOf(opts), cache ? &*cache : nullptr);
+    if (cache) {
+      cache->save();
+      if (verbose) {
+        std::cout << cache->hits()   << " fields from cache\n"
+                  << cache->misses() << " fields inset\n\n";
+      }
+    }
+  }
+  {
+    auto scope = farm_db::StatsScope{wantStats ? &total : nullptr};
+    auto timer = farm_db::StageTimer{Stats::Write};
+    WriteOutput(db, output, opts);
+  }
+
+  if (wantStats) {
+    for (const auto& s: fieldStats)
+      total += s;
+    WriteStats(opts.statsPath, input, db, total, fieldStats);
+  }
+  return db.fields.size();
+} // Process
+
+/// Handles one --serve request line; returns the reply after "ok ".
+std::string ServeRequest(farm_db::FarmDb& db, const std::string& line,
+                         const Options& opts,
+                         const farm_db::InsetOptions& options)
+{
+  auto words = std::istringstream{line};
+  auto cmd = std::string{};
+  auto outStr = std::string{};
+  words >> cmd;
+  if (cmd != "inset")
+    throw std::runtime_error{"unknown request: " + cmd};
+  if (!(words >> outStr))
+    throw std::runtime_error{"missing output"};
+  const auto output = fs::path{outStr};
+  if (!IsOutputExt(output))
+    throw std::runtime_error{"unsupported output file extension"};
+  if (output == opts.inputPath)
+    throw std::runtime_error{"output file is the input file"};
+  auto dists = std::vector<farm_db::Distance>{};
+  auto ft = 0.0;
+  auto prev = 0.0;
+  while (words >> ft) {
+    if (ft <= 0.5)
+      throw std::runtime_error{"inset distance must be > 0.5 ft"};
+    if (ft <= prev)
+      throw std::runtime_error{"inset distances must be increasing"};
+    prev = ft;
+    dists.push_back(ft * mp_units::yard_pound::foot);
+  }
+  if (!words.eof())
+    throw std::runtime_error{"invalid inset distance"};
+  if (dists.empty())
+    throw std::runtime_error{"missing inset distance"};
+
+  const auto start = std::chrono::steady_clock::now();
+  db.inset(opts.insetName, dists, opts.threads, nullptr, options);
+  WriteOutput(db, output, opts);
+  const auto ms = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start);
+  return std::format("{} fields {:.3f} ms", db.fields.size(), ms.count());
+} // ServeRequest
+
+/// Loads the input once and answers requests from stdin until "quit" or
+/// end of input.  Each field keeps its projection and its projected,
+/// validated parts between requests, so a request pays only for buffering,
+/// simplification, inverse projection and output.
+int Serve(const Options& opts) {
+  auto db = ReadInput(opts.inputPath, opts);
+  auto options = InsetOptionsOf(opts);
+  options.warm = true;
+  std::cout << "ready " << db.fields.size() << " fields" << std::endl;
+  auto line = std::string{};
+  while (std::getline(std::cin, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (line.find_first_not_of(" \t") == std::string::npos)
+      continue;
+    if (line == "quit")
+      break;
+    try {
+      const auto reply = ServeRequest(db, line, opts, options);
+      std::cout << "ok " << reply;
+    }
+    catch (const std::exception& x) {
+      std::cout << "error " << x.what();
     }
+    std::cout << std::endl;
+  }
+  return 0;
+} // Serve
+
+/// The inputs named by a manifest file, or found in a directory.
+std::vector<fs::path> BatchInputs(const fs::path& batch) {
+  auto inputs = std::vector<fs::path>{};
+  if (fs::is_directory(batch)) {
+    for (const auto& entry: fs::directory_iterator{batch}) {
+      if (entry.is_regular_file() && IsInputExt(entry.path()))
+        inputs.push_back(entry.path());
+    }
+    std::ranges::sort(inputs);
+    return inputs;
+  }
+  auto in = std::ifstream{batch};
+  if (!in)
+    throw std::runtime_error{"cannot open manifest: " + batch.string()};
+  // Relative paths in a manifest are relative to the manifest.
+  const auto base = batch.parent_path();
+  auto line = std::string{};
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (line.empty() || line.front() == '#')
+      continue;
+    const auto path = fs::path{line};
+    inputs.push_back(path.is_absolute() ? path : base / path);
+  }
+  return inputs;
+} // BatchInputs
+
+/// Processes every batch input on `opts.jobs` workers.  A failure is
+/// reported and counted; it does not stop the other files.
+int RunBatch(const Options& opts) {
+  const auto inputs  = BatchInputs(opts.batchPath);
+  const auto pattern = opts.outputPath.string();
+
+  auto outputs = std::vector<fs::path>{};
+  outputs.reserve(inputs.size());
+  auto seen = std::set<fs::path>{};
+  for (const auto& input: inputs) {
+    auto output = BatchOutput(pattern, input);
+    if (!seen.insert(output).second) {
+      std::cerr << "Error: several inputs map to " << output << '\n';
+      return 2;
+    }
+    outputs.push_back(std::move(output));
+  }
+
+  auto mtx    = std::mutex{};
+  auto failed = std::size_t{0};
+  tjg::ParallelFor(inputs.size(), opts.jobs, [&](std::size_t i) {
+    const auto& input  = inputs[i];
+    const auto& output = outputs[i];
+    auto msg = std::string{};
+    auto nFields = std::size_t{0};
+    try {
+      if (!IsInputExt(input))
+        throw std::runtime_error{"unsupported input file extension"};
+      if (output == input)
+        throw std::runtime_error{"output file is the input file"};
+      if (output.has_parent_path())
+        fs::create_directories(output.parent_path());
+      nFields = Process(input, output, opts, false);
+    }
+    catch (const std::exception& x) {
+      msg = x.what();
+    }
+    catch (...) {
+      msg = "unknown exception";
+    }
+    const auto lock = std::lock_guard{mtx};
+    if (msg.empty()) {
+      std::cout << "ok     " << input.string() << " -> " << output.string()
+                << " (" << nFields << " fields)\n";
+    } else {
+      ++failed;
+      std::cout << "FAILED " << input.string() << ": " << msg << '\n';
+    }
+    std::cout.flush();
+  });
+
+  std::cout << '\n' << inputs.size() << " files: "
+            << (inputs.size() - failed) << " succeeded, "
+            << failed << " failed\n";
+  return (failed == 0) ? 0 : 1;
+} // RunBatch
+
+int main(int argc, const char* argv[]) {
+  try {
+    std::cout << "InsetXml v0.0 built on " __DATE__ " " __TIME__ << '\n';
+
+    const auto opts = ParseArgs(argc, argv);
+    if (!opts)
+      return 1;
+
+    if (opts->serve)
+      return Serve(*opts);
+
+    if (!opts->batchPath.empty())
+      return RunBatch(*opts);
+
+    Process(opts->inputPath, opts->outputPath, *opts, true);
     std::cerr << "Successful completion.\n";
     return 0;
   }
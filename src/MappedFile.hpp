@@ -0,0 +1,88 @@
+/// @file
+/// Read-only memory mapping of a whole file.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <cstddef>
+
+namespace tjg {
+
+class MappedFile {
+  void*       _addr = nullptr;
+  std::size_t _size = 0;
+
+  [[noreturn]] static void die(const std::filesystem::path& path,
+                               const char* what, int err)
+  {
+    throw std::runtime_error{path.string() + ": " + what + ": "
+                             + std::strerror(err)};
+  } // die
+
+public:
+  MappedFile() = default;
+
+  explicit MappedFile(const std::filesystem::path& path) {
+    const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      die(path, "cannot open file", errno);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      const auto err = errno;
+      ::close(fd);
+      die(path, "cannot stat file", err);
+    }
+    _size = static_cast<std::size_t>(st.st_size);
+    if (_size != 0) {
+      _addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (_addr == MAP_FAILED) {
+        const auto err = errno;
+        _addr = nullptr;
+        ::close(fd);
+        die(path, "cannot map file", err);
+      }
+    }
+    ::close(fd); // the mapping stays valid
+  } // ctor
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& rhs) noexcept
+    : _addr{std::exchange(rhs._addr, nullptr)}
+    , _size{std::exchange(rhs._size, 0)}
+  { }
+
+  MappedFile& operator=(MappedFile&& rhs) noexcept {
+    std::swap(_addr, rhs._addr);
+    std::swap(_size, rhs._size);
+    return *this;
+  } // move
+
+  ~MappedFile() noexcept {
+    if (_addr)
+      ::munmap(_addr, _size);
+  } // dtor
+
+  const std::byte* data() const noexcept
+    { return static_cast<const std::byte*>(_addr); }
+
+  std::size_t size() const noexcept { return _size; }
+
+  std::span<const std::byte> bytes() const noexcept
+    { return {data(), _size}; }
+}; // MappedFile
+
+} // tjg
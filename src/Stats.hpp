@@ -0,0 +1,121 @@
+/// @file
+/// Opt-in per-stage timers and counters.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// Code under test marks its stages with StageTimer and bumps counters on
+/// Stats::Current().  Nothing is recorded unless the thread has selected a
+/// Stats with StatsScope, so the cost when disabled is one thread-local
+/// load per stage.
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace farm_db {
+
+struct Stats {
+  enum Stage {
+    Parse,         // reading the input file
+    Project,       // building projections and projecting to the plane
+    Validate,      // EnsureValid
+    Buffer,        // ggl::buffer for the inset
+    Simplify,      // every Simplify attempt, the first included
+    SimplifyRetry, // attempts after the first, at a halved tolerance
+    Inverse,       // projecting insets back to lat/lon
+    Write,         // serializing the output
+    NumStages
+  }; // Stage
+
+  using Clock = std::chrono::steady_clock;
+
+  std::array<Clock::duration, NumStages> time{};
+  std::uint64_t verticesIn  = 0;  // points of the polygons inset
+  std::uint64_t verticesOut = 0;  // points of the simplified insets
+  std::uint64_t simplifyCalls    = 0;
+  std::uint64_t simplifyHalvings = 0;
+  std::uint64_t validQuick = 0;  // validity settled by the cheap tests
+  std::uint64_t validFull  = 0;  // validity needing ggl::is_valid
+
+  Stats& operator+=(const Stats& rhs) noexcept {
+    for (auto i = std::size_t{0}; i != time.size(); ++i)
+      time[i] += rhs.time[i];
+    verticesIn       += rhs.verticesIn;
+    verticesOut      += rhs.verticesOut;
+    simplifyCalls    += rhs.simplifyCalls;
+    simplifyHalvings += rhs.simplifyHalvings;
+    validQuick       += rhs.validQuick;
+    validFull        += rhs.validFull;
+    return *this;
+  } // +=
+
+  /// The collector selected by the innermost StatsScope on this thread.
+  static Stats* Current() noexcept { return CurrentRef(); }
+
+private:
+  static Stats*& CurrentRef() noexcept {
+    thread_local Stats* current = nullptr;
+    return current;
+  } // CurrentRef
+
+  friend class StatsScope;
+}; // Stats
+
+inline const char* Name(Stats::Stage x) noexcept {
+  switch (x) {
+    case Stats::Parse:         return "parse";
+    case Stats::Project:       return "project";
+    case Stats::Validate:      return "validate";
+    case Stats::Buffer:        return "buffer";
+    case Stats::Simplify:      return "simplify";
+    case Stats::SimplifyRetry: return "simplifyRetry";
+    case Stats::Inverse:       return "inverse";
+    case Stats::Write:         return "write";
+    default: return nullptr;
+  }
+} // Name(Stats::Stage)
+
+/// Selects `stats` for this thread until the scope ends.
+class StatsScope {
+  Stats* _prev;
+
+public:
+  explicit StatsScope(Stats* stats) noexcept
+    : _prev{std::exchange(Stats::CurrentRef(), stats)} { }
+
+  StatsScope(const StatsScope&) = delete;
+  StatsScope& operator=(const StatsScope&) = delete;
+
+  ~StatsScope() noexcept { Stats::CurrentRef() = _prev; }
+}; // StatsScope
+
+/// Adds the time until destruction, or until stop(), to one stage.
+class StageTimer {
+  Stats* _stats;
+  Stats::Stage _stage;
+  Stats::Clock::time_point _start;
+
+public:
+  explicit StageTimer(Stats::Stage stage) noexcept
+    : _stats{Stats::Current()}, _stage{stage}
+  {
+    if (_stats)
+      _start = Stats::Clock::now();
+  }
+
+  StageTimer(const StageTimer&) = delete;
+  StageTimer& operator=(const StageTimer&) = delete;
+
+  void stop() noexcept {
+    if (_stats)
+      _stats->time[_stage] += Stats::Clock::now() - _start;
+    _stats = nullptr;
+  } // stop
+
+  ~StageTimer() noexcept { stop(); }
+}; // StageTimer
+
+} // farm_db
@@ -0,0 +1,56 @@
+/// @file
+/// Interned, arena-backed strings.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// ISOXML repeats the same attribute keys and values on element after
+/// element.  A StringPool keeps one copy of each distinct string in its own
+/// Arena and hands out string_views of it, so a repeated value costs no
+/// allocation and freeing the pool is a handful of block frees.  The views
+/// live as long as the pool.  A StringPool is not thread safe.
+#pragma once
+
+#include "Arena.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <unordered_set>
+
+namespace tjg {
+
+class StringPool {
+  using Index = std::unordered_set<std::string_view,
+                                   std::hash<std::string_view>,
+                                   std::equal_to<std::string_view>,
+                                   ArenaAllocator<std::string_view>>;
+
+  Arena _arena;  // declared first: the index lives in it
+  Index _index{0, Index::hasher{}, Index::key_equal{},
+               Index::allocator_type{&_arena}};
+
+public:
+  StringPool() = default;
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+
+  /// The pool's copy of `s`, made on first sight.
+  std::string_view intern(std::string_view s) {
+    if (s.empty())
+      return {};
+    auto it = _index.find(s);
+    if (it != _index.end())
+      return *it;
+    auto p = static_cast<char*>(_arena.allocate(s.size(), 1));
+    std::memcpy(p, s.data(), s.size());
+    return *_index.emplace(p, s.size()).first;
+  } // intern
+
+  std::size_t size() const noexcept { return _index.size(); }
+
+  /// Bytes reserved from the heap, strings and index together.
+  std::size_t capacity() const noexcept { return _arena.capacity(); }
+}; // StringPool
+
+} // tjg
@@ -0,0 +1,72 @@
+/// @file
+/// Where each customer, farm and field lies in a TASKDATA file.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// Scan() passes over the document once, reading only the start tags of the
+/// root's children and skipping their contents, and records each element's
+/// byte range.  load() then parses just the chosen fields, the customers
+/// and farms they belong to, and the root's attributes, so its cost follows
+/// the size of those fields rather than of the file.  In a .zip the offsets
+/// are into the decompressed TASKDATA.XML, which load() must decompress up
+/// to the last field it reads, but without parsing the bytes in between.
+#pragma once
+#include "FarmDb.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace farm_db {
+
+class TaskDataIndex {
+public:
+  /// Bytes [begin, end) of an element in the (decompressed) document.
+  struct Extent {
+    std::uint64_t begin = 0;
+    std::uint64_t end   = 0;
+  }; // Extent
+
+  struct FieldEntry {
+    std::string id;        ///< "PFD<n>"
+    std::string name;
+    std::string customer;  ///< "CTR<n>", or empty
+    std::string farm;      ///< "FRM<n>", or empty
+    Extent extent;
+  }; // FieldEntry
+
+  /// Indexes a TASKDATA .xml, or the TASKDATA/TASKDATA.XML of a .zip.
+  static TaskDataIndex Scan(const std::filesystem::path& input);
+
+  const std::filesystem::path& path() const noexcept { return _path; }
+  const std::vector<FieldEntry>& fields() const noexcept { return _fields; }
+
+  /// The field whose id is `key`, or else the first one named `key`.
+  std::optional<std::size_t> find(std::string_view key) const;
+
+  /// A FarmDb of just the fields at `which`, in file order, with their
+  /// customers and farms and the root attributes.  Each element is checked
+  /// exactly as ReadXml checks it.
+  FarmDb load(std::span<const std::size_t> which) const;
+
+private:
+  struct FarmEntry {
+    Extent extent;
+    std::string customer;
+  }; // FarmEntry
+
+  std::filesystem::path _path;
+  bool _zipped = false;
+  Extent _root;  // the root start tag
+  std::unordered_map<std::string, Extent>    _customers;
+  std::unordered_map<std::string, FarmEntry> _farms;
+  std::vector<FieldEntry> _fields;
+}; // TaskDataIndex
+
+} // farm_db
@@ -0,0 +1,164 @@
+/// @file
+/// ggl::is_valid behind cheap tests that often settle the answer.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// The full test looks for self-intersections, which costs a sort and a
+/// sweep over every segment.  A planar ring whose turns all go the same way
+/// and that winds once is convex, hence simple, so only its orientation is
+/// left to know; inset rings of ordinary fields mostly are.  A multipolygon
+/// of such rings whose envelopes are disjoint is valid as well.  Anything
+/// the cheap tests cannot prove, including every near-degenerate turn, goes
+/// to ggl::is_valid, so the answer, failure type included, is always the one
+/// ggl::is_valid would give.  Geographic geometry always takes the full test.
+#pragma once
+#include "Stats.hpp"
+
+#include <boost/geometry/algorithms/is_valid.hpp>
+#include <boost/geometry/core/point_order.hpp>
+#include <boost/geometry/core/tags.hpp>
+#include <boost/geometry/core/cs.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <optional>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+
+namespace farm_db {
+
+namespace ggl = boost::geometry;
+
+namespace validity {
+
+using Failure = ggl::validity_failure_type;
+
+// Past this many polygons the pairwise envelope test is not worth it.
+constexpr std::size_t MaxQuickPolygons = 32;
+
+// Turns this close to straight, or to straight back, are left to ggl,
+// whose robust predicates may call them collinear or a spike.
+constexpr double MinSine = 1e-9;
+
+struct Envelope {
+  double minX, minY, maxX, maxY;
+  bool disjoint(const Envelope& rhs) const noexcept {
+    return maxX < rhs.minX || rhs.maxX < minX
+        || maxY < rhs.minY || rhs.maxY < minY;
+  }
+}; // Envelope
+
+template<class Ring>
+std::optional<Failure> QuickRing(const Ring& ring, Envelope* env = nullptr) {
+  using ggl::get;
+  const auto n = ring.size();
+  if (n < 4)
+    return std::nullopt;
+  const auto& first = ring.front();
+  const auto& last  = ring.back();
+  if (get<0>(first) != get<0>(last) || get<1>(first) != get<1>(last))
+    return std::nullopt;
+
+  auto box = Envelope{get<0>(first), get<1>(first),
+                      get<0>(first), get<1>(first)};
+  auto px = get<0>(ring[n-1]) - get<0>(ring[n-2]);
+  auto py = get<1>(ring[n-1]) - get<1>(ring[n-2]);
+  auto sign = 0;
+  auto turning = 0.0;
+  for (auto i = std::size_t{0}; i + 1 != n; ++i) {
+    const auto x = get<0>(ring[i]), y = get<1>(ring[i]);
+    const auto cx = get<0>(ring[i+1]) - x;
+    const auto cy = get<1>(ring[i+1]) - y;
+    const auto cross = px * cy - py * cx;
+    const auto dot   = px * cx + py * cy;
+    const auto scale = std::hypot(px, py) * std::hypot(cx, cy);
+    if (!std::isfinite(cross) || !(std::abs(cross) > MinSine * scale))
+      return std::nullopt;
+    const auto s = (cross > 0) ? 1 : -1;
+    if (sign != s && sign != 0)
+      return std::nullopt;
+    sign = s;
+    turning += std::atan2(cross, dot);
+    box.minX = std::min(box.minX, x);
+    box.maxX = std::max(box.maxX, x);
+    box.minY = std::min(box.minY, y);
+    box.maxY = std::max(box.maxY, y);
+    px = cx;
+    py = cy;
+  }
+  // Turning through 4*pi or more is a star, which crosses itself.
+  if (std::abs(turning) > 3 * std::numbers::pi)
+    return std::nullopt;
+  if (env)
+    *env = box;
+  const auto clockwise = (sign < 0);
+  const auto wantCw = (ggl::point_order<Ring>::value == ggl::clockwise);
+  return (clockwise == wantCw) ? ggl::no_failure
+                               : ggl::failure_wrong_orientation;
+} // QuickRing
+
+template<class Poly>
+std::optional<Failure> QuickPolygon(const Poly& poly, Envelope* env = nullptr)
+{
+  if (!poly.inners().empty())
+    return std::nullopt;
+  return QuickRing(poly.outer(), env);
+} // QuickPolygon
+
+template<class Multi>
+std::optional<Failure> QuickMulti(const Multi& mp) {
+  if (mp.empty() || mp.size() > MaxQuickPolygons)
+    return std::nullopt;
+  auto boxes = std::vector<Envelope>(mp.size());
+  auto result = ggl::no_failure;
+  for (auto i = std::size_t{0}; i != mp.size(); ++i) {
+    const auto r = QuickPolygon(mp[i], &boxes[i]);
+    if (!r)
+      return std::nullopt;
+    if (*r != ggl::no_failure)
+      result = *r;
+    for (auto j = std::size_t{0}; j != i; ++j) {
+      if (!boxes[i].disjoint(boxes[j]))
+        return std::nullopt;
+    }
+  }
+  return result;
+} // QuickMulti
+
+/// What the cheap tests prove about `geo`, if anything.
+template<class Geo>
+std::optional<Failure> Quick(const Geo& geo) {
+  using Cs  = typename ggl::cs_tag<Geo>::type;
+  using Tag = typename ggl::tag<Geo>::type;
+  if constexpr (!std::is_same_v<Cs, ggl::cartesian_tag>)
+    return std::nullopt;
+  else if constexpr (std::is_same_v<Tag, ggl::ring_tag>)
+    return QuickRing(geo);
+  else if constexpr (std::is_same_v<Tag, ggl::polygon_tag>)
+    return QuickPolygon(geo);
+  else if constexpr (std::is_same_v<Tag, ggl::multi_polygon_tag>)
+    return QuickMulti(geo);
+  else
+    return std::nullopt;
+} // Quick
+
+} // validity
+
+/// As ggl::is_valid(geo, failure).
+template<class Geo>
+bool IsValid(const Geo& geo, ggl::validity_failure_type& failure) {
+  auto stats = Stats::Current();
+  if (const auto quick = validity::Quick(geo)) {
+    if (stats)
+      ++stats->validQuick;
+    failure = *quick;
+    return failure == ggl::no_failure;
+  }
+  if (stats)
+    ++stats->validFull;
+  return ggl::is_valid(geo, failure);
+} // IsValid
+
+} // farm_db
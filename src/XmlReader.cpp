@@ -0,0 +1,338 @@
+/// @file
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+#include "XmlReader.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <format>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+namespace tjg {
+
+namespace {
+
+constexpr bool IsSpace(int c) noexcept
+  { return (c == ' ' || c == '\t' || c == '\n' || c == '\r'); }
+
+constexpr bool IsNameEnd(int c) noexcept
+  { return (IsSpace(c) || c == '/' || c == '>' || c == '=' || c < 0); }
+
+void AppendUtf8(std::string& out, std::uint32_t cp) {
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    out += static_cast<char>(0xC0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += static_cast<char>(0xE0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+} // AppendUtf8
+
+XmlReader::ReadFn FileReader(const std::filesystem::path& path) {
+  auto is = std::make_shared<std::ifstream>(path, std::ios::binary);
+  if (!*is)
+    throw std::runtime_error{path.string() + ": cannot open file"};
+  return [is](char* buf, std::size_t size) -> std::size_t {
+    if (!*is) return 0;
+    is->read(buf, static_cast<std::streamsize>(size));
+    return static_cast<std::size_t>(is->gcount());
+  };
+} // FileReader
+
+} // local
+
+XmlReader::XmlReader(ReadFn read, std::string source, std::uint64_t offset)
+  : _read{std::move(read)}, _source{std::move(source)}, _buf(BufSize)
+  , _bufOffset{offset}
+{
+  // Skip a UTF-8 byte order mark.
+  if (offset == 0 && fill() && _end >= 3
+      && _buf[0] == '\xEF' && _buf[1] == '\xBB' && _buf[2] == '\xBF')
+  {
+    _pos = 3;
+  }
+} // ctor
+
+XmlReader::XmlReader(const std::filesystem::path& path)
+  : XmlReader{FileReader(path), path.string()}
+{ } // ctor
+
+bool XmlReader::fill() {
+  if (_eof) return false;
+  _bufOffset += _end;
+  _pos = _end = 0;
+  _end = _read(_buf.data(), _buf.size());
+  if (_end == 0) _eof = true;
+  return !_eof;
+} // fill
+
+void XmlReader::error(const std::string& what) const {
+  auto msg = std::format("{}: XML parse error: {} (offset {})",
+                         _source, what, _tagOffset);
+  throw std::runtime_error{msg};
+} // error
+
+int XmlReader::require(const char* what) {
+  auto c = get();
+  if (c < 0) error(std::string{"unexpected end of file in "} + what);
+  return c;
+} // require
+
+void XmlReader::expect(char c, const char* what) {
+  if (require(what) != static_cast<unsigned char>(c))
+    error(std::string{"expected '"} + c + "' in " + what);
+} // expect
+
+void XmlReader::skipSpace() {
+  while (IsSpace(peek()))
+    ++_pos;
+} // skipSpace
+
+void XmlReader::skipPast(std::string_view terminator, const char* what) {
+  auto matched = std::size_t{0};
+  while (matched != terminator.size()) {
+    auto c = require(what);
+    if (c == static_cast<unsigned char>(terminator[matched]))
+      ++matched;
+    else
+      matched = (c == static_cast<unsigned char>(terminator[0])) ? 1 : 0;
+  }
+} // skipPast
+
+// Positioned just after "<!".
+void XmlReader::skipMarkup() {
+  if (peek() == '-') {
+    ++_pos;
+    expect('-', "comment");
+    skipPast("-->", "comment");
+    return;
+  }
+  if (peek() == '[') {
+    skipPast("]]>", "CDATA section");
+    return;
+  }
+  // DOCTYPE or other declaration, possibly with an internal subset.
+  int nest = 0;
+  for (;;) {
+    auto c = require("declaration");
+    if      (c == '[') ++nest;
+    else if (c == ']') --nest;
+    else if (c == '>' && nest <= 0) return;
+  }
+} // skipMarkup
+
+void XmlReader::readName(std::string& out) {
+  out.clear();
+  while (!IsNameEnd(peek()))
+    out += static_cast<char>(_buf[_pos++]);
+  if (out.empty()) error("missing name");
+} // readName
+
+// Positioned just after '&'.
+void XmlReader::readEntity(bool keep) {
+  auto ent = std::string_view{};
+  char tmp[12];
+  auto n = std::size_t{0};
+  for (;;) {
+    auto c = peek();
+    if (c == ';') { ++_pos; break; }
+    if (c < 0 || c == '<' || c == '&' || c == '"' || c == '\''
+        || IsSpace(c) || n == sizeof(tmp))
+    {
+      // Not an entity reference: keep the text as written.
+      if (keep) { _text += '&'; _text.append(tmp, n); }
+      return;
+    }
+    tmp[n++] = static_cast<char>(c);
+    ++_pos;
+  }
+  ent = std::string_view{tmp, n};
+  if (!keep) return;
+  if      (ent == "lt")   _text += '<';
+  else if (ent == "gt")   _text += '>';
+  else if (ent == "amp")  _text += '&';
+  else if (ent == "quot") _text += '"';
+  else if (ent == "apos") _text += '\'';
+  else if (n > 1 && ent[0] == '#') {
+    auto cp = std::uint32_t{0};
+    auto hex = (ent[1] == 'x');
+    bool ok = (n > (hex ? 2u : 1u));
+    for (auto i = hex ? 2u : 1u; ok && i != n; ++i) {
+      auto d = ent[i];
+      if (d >= '0' && d <= '9')
+        cp = cp * (hex ? 16 : 10) + static_cast<std::uint32_t>(d - '0');
+      else if (hex && d >= 'a' && d <= 'f')
+        cp = cp * 16 + static_cast<std::uint32_t>(d - 'a' + 10);
+      else if (hex && d >= 'A' && d <= 'F')
+        cp = cp * 16 + static_cast<std::uint32_t>(d - 'A' + 10);
+      else
+        ok = false;
+      if (cp > 0x10FFFF) ok = false;
+    }
+    if (ok) {
+      AppendUtf8(_text, cp);
+    } else {
+      _text += '&';
+      _text += ent;
+      _text += ';';
+    }
+  }
+  else {
+    // Unknown entity: keep as written, as pugixml does.
+    _text += '&';
+    _text += ent;
+    _text += ';';
+  }
+} // readEntity
+
+void XmlReader::readAttrValue(int quote, bool keep) {
+  for (;;) {
+    auto c = require("attribute value");
+    if (c == quote) return;
+    if (c == '&') { readEntity(keep); continue; }
+    if (c == '<') error("'<' in attribute value");
+    if (!keep) continue;
+    if (c == '\r') {
+      _text += ' ';
+      if (peek() == '\n') ++_pos;
+    } else if (c == '\t' || c == '\n') {
+      _text += ' ';
+    } else {
+      _text += static_cast<char>(c);
+    }
+  }
+} // readAttrValue
+
+// Positioned just after '<', at the first character of the element name.
+void XmlReader::readStartTag(bool keep) {
+  _text.clear();
+  _attrOffsets.clear();
+  _attrs.clear();
+  auto& name = _open.emplace_back();
+  readName(name);
+  auto attrName = std::string{};
+  for (;;) {
+    skipSpace();
+    auto c = require("start tag");
+    if (c == '>') break;
+    if (c == '/') {
+      expect('>', "start tag");
+      _pendingEnd = true;
+      break;
+    }
+    --_pos;
+    readName(attrName);
+    skipSpace();
+    expect('=', "attribute");
+    skipSpace();
+    auto q = require("attribute");
+    if (q != '"' && q != '\'') error("attribute value must be quoted");
+    if (keep) {
+      const auto nameOff = _text.size();
+      _text += attrName;
+      _text += '\0';
+      const auto valueOff = _text.size();
+      readAttrValue(q, keep);
+      _text += '\0';
+      _attrOffsets.emplace_back(nameOff, valueOff);
+    } else {
+      readAttrValue(q, keep);
+    }
+  }
+  // _text is complete, so its storage is stable until the next tag.
+  for (const auto& [n, v]: _attrOffsets)
+    _attrs.emplace_back(_text.data() + n, _text.data() + v);
+  _attrsValid = keep;
+} // readStartTag
+
+// Positioned just after "</".
+void XmlReader::readEndTag() {
+  readName(_endName);
+  skipSpace();
+  expect('>', "end tag");
+  if (_open.empty())
+    error("unexpected end tag </" + _endName + ">");
+  if (_open.back() != _endName) {
+    error("mismatched end tag </" + _endName + ">, expected </"
+           + _open.back() + ">");
+  }
+  _open.pop_back();
+} // readEndTag
+
+XmlReader::Event XmlReader::advance(bool keep) {
+  _attrsValid = false;
+  if (_pendingEnd) {
+    _pendingEnd = false;
+    _endName = std::move(_open.back());
+    _open.pop_back();
+    return _event = Event::End;
+  }
+  for (;;) {
+    // Character data is not part of the model; skip to the next tag.
+    for (;;) {
+      auto c = peek();
+      if (c < 0) {
+        if (!_open.empty()) {
+          _tagOffset = position();
+          error("unexpected end of file in <" + _open.back() + ">");
+        }
+        return _event = Event::Eof;
+      }
+      if (c == '<') break;
+      ++_pos;
+    }
+    _tagOffset = position();
+    ++_pos;
+    auto c = require("tag");
+    if (c == '?') {
+      skipPast("?>", "processing instruction");
+      continue;
+    }
+    if (c == '!') {
+      skipMarkup();
+      continue;
+    }
+    if (c == '/') {
+      readEndTag();
+      return _event = Event::End;
+    }
+    --_pos;
+    readStartTag(keep);
+    return _event = Event::Start;
+  }
+} // advance
+
+void XmlReader::skip() {
+  if (_event != Event::Start) return;
+  const auto depth0 = _open.size();
+  for (;;) {
+    auto ev = advance(false);
+    if (ev == Event::End && _open.size() < depth0) return;
+    if (ev == Event::Eof) return; // advance() has already thrown
+  }
+} // skip
+
+XmlAttr XmlReader::attribute(std::string_view key) const noexcept {
+  if (!_attrsValid) return XmlAttr{};
+  for (const auto& a: _attrs) {
+    if (key == a.name())
+      return a;
+  }
+  return XmlAttr{};
+} // attribute
+
+} // tjg
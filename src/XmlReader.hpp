@@ -0,0 +1,143 @@
+/// @file
+/// Minimal pull parser for element/attribute XML such as ISOXML TASKDATA.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// The reader walks the input once and keeps only the open element names and
+/// the attributes of the current tag, so memory does not grow with the file.
+/// Character data, comments, CDATA, processing instructions and DOCTYPE
+/// declarations are skipped.  Attribute values are unescaped and have
+/// tab/CR/LF converted to spaces, matching pugixml's default parse.
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace tjg {
+
+/// One attribute of the current start tag; valid until XmlReader::next().
+class XmlAttr {
+  const char* _name  = nullptr;
+  const char* _value = nullptr;
+
+public:
+  XmlAttr() = default;
+  XmlAttr(const char* name_, const char* value_) noexcept
+    : _name{name_}, _value{value_} { }
+
+  const char* name()  const noexcept { return _name  ? _name  : ""; }
+  const char* value() const noexcept { return _value ? _value : ""; }
+
+  explicit operator bool() const noexcept { return (_name != nullptr); }
+}; // XmlAttr
+
+class XmlReader {
+public:
+  /// Fills up to `size` bytes of `buf`; returns 0 at end of input.
+  using ReadFn = std::function<std::size_t(char* buf, std::size_t size)>;
+
+  enum class Event { None, Start, End, Eof };
+
+private:
+  static constexpr std::size_t BufSize = 64 * 1024;
+
+  ReadFn _read;
+  std::string _source;
+  std::vector<char> _buf;
+  std::size_t _pos = 0;
+  std::size_t _end = 0;
+  std::uint64_t _bufOffset = 0;  // stream offset of _buf[0]
+  bool _eof = false;
+
+  Event _event = Event::None;
+  std::uint64_t _tagOffset = 0;
+  std::vector<std::string> _open; // names of open elements
+  std::string _endName;
+  bool _pendingEnd = false;       // self-closing tag not yet reported
+  bool _attrsValid = false;
+
+  std::string _text;              // name\0value\0... of current attributes
+  std::vector<std::pair<std::size_t, std::size_t>> _attrOffsets;
+  std::vector<XmlAttr> _attrs;
+
+  bool fill();
+  int peek() {
+    if (_pos == _end && !fill()) return -1;
+    return static_cast<unsigned char>(_buf[_pos]);
+  }
+  int get() {
+    if (_pos == _end && !fill()) return -1;
+    return static_cast<unsigned char>(_buf[_pos++]);
+  }
+  std::uint64_t position() const noexcept { return _bufOffset + _pos; }
+
+  int require(const char* what);
+  void expect(char c, const char* what);
+  void skipSpace();
+  void skipPast(std::string_view terminator, const char* what);
+  void skipMarkup();
+  void readName(std::string& out);
+  void readAttrValue(int quote, bool keep);
+  void readEntity(bool keep);
+  void readStartTag(bool keep);
+  void readEndTag();
+  Event advance(bool keep);
+
+public:
+  /// `source` names the input in error messages.  `offset` is the stream
+  /// offset of the first byte `read` returns, for readers started mid-file.
+  XmlReader(ReadFn read, std::string source, std::uint64_t offset = 0);
+
+  /// Reads a file in binary mode.
+  explicit XmlReader(const std::filesystem::path& path);
+
+  XmlReader(const XmlReader&) = delete;
+  XmlReader& operator=(const XmlReader&) = delete;
+
+  /// Advances to the next start tag, end tag, or end of input.  A
+  /// self-closing tag is reported as a Start followed by an End.
+  Event next() { return advance(true); }
+
+  /// Consumes the rest of the current element, up to its End, without
+  /// decoding any nested attributes.  Call while positioned on a Start.
+  void skip();
+
+  Event event() const noexcept { return _event; }
+
+  /// Name of the element for the current Start or End event.
+  std::string_view name() const noexcept {
+    if (_event == Event::End) return _endName;
+    return _open.empty() ? std::string_view{} : std::string_view{_open.back()};
+  }
+
+  /// Nesting depth of the current element; the document root is depth 1.
+  int depth() const noexcept {
+    auto d = static_cast<int>(_open.size());
+    return (_event == Event::End) ? d + 1 : d;
+  }
+
+  /// Stream offset of the '<' that began the current tag.
+  std::uint64_t offset() const noexcept { return _tagOffset; }
+
+  const std::string& source() const noexcept { return _source; }
+
+  /// Attributes of the current start tag, in document order.
+  std::span<const XmlAttr> attributes() const noexcept {
+    if (!_attrsValid) return {};
+    return std::span<const XmlAttr>{_attrs};
+  }
+
+  /// The named attribute of the current start tag, or an empty XmlAttr.
+  XmlAttr attribute(std::string_view key) const noexcept;
+
+  [[noreturn]] void error(const std::string& what) const;
+}; // XmlReader
+
+} // tjg
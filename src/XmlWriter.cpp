@@ -0,0 +1,118 @@
+/// @file
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+#include "XmlWriter.hpp"
+
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <cstddef>
+
+namespace tjg {
+
+namespace {
+
+// Attribute escaping as done by pugixml's text_output_escaped() with
+// ctx_special_attr: '&', '<' and '"' become entities, control characters
+// become two-digit character references, and '>' and '\'' pass through.
+void AppendEscaped(std::string& out, std::string_view s) {
+  auto first = s.begin();
+  for (auto p = first; p != s.end(); ++p) {
+    const auto c = static_cast<unsigned char>(*p);
+    if (c >= 32 && c != '&' && c != '<' && c != '"')
+      continue;
+    out.append(first, p);
+    first = p + 1;
+    switch (c) {
+      case '&': out += "&amp;";  break;
+      case '<': out += "&lt;";   break;
+      case '"': out += "&quot;"; break;
+      default:
+        out += "&#";
+        out += static_cast<char>('0' + c / 10);
+        out += static_cast<char>('0' + c % 10);
+        out += ';';
+        break;
+    }
+  }
+  out.append(first, s.end());
+} // AppendEscaped
+
+} // local
+
+void XmlWriter::closeTag() {
+  if (!_inTag) return;
+  _out += ">\n";
+  _inTag = false;
+} // closeTag
+
+void XmlWriter::indent(std::size_t depth) {
+  for (auto i = std::size_t{0}; i != depth; ++i)
+    _out += _indent;
+} // indent
+
+XmlWriter& XmlWriter::declaration(std::string_view version,
+                                  std::string_view encoding)
+{
+  _out += "<?xml version=\"";
+  AppendEscaped(_out, version);
+  _out += "\" encoding=\"";
+  AppendEscaped(_out, encoding);
+  _out += "\"?>\n";
+  return *this;
+} // declaration
+
+XmlWriter& XmlWriter::start(std::string_view name) {
+  closeTag();
+  indent(_open.size());
+  _out += '<';
+  _out += name;
+  _open.emplace_back(name);
+  _inTag = true;
+  return *this;
+} // start
+
+XmlWriter& XmlWriter::end() {
+  if (_open.empty())
+    throw std::logic_error{"XmlWriter::end: no open element"};
+  if (_inTag) {
+    _out += " />\n";
+    _inTag = false;
+  } else {
+    indent(_open.size() - 1);
+    _out += "</";
+    _out += _open.back();
+    _out += ">\n";
+  }
+  _open.pop_back();
+  return *this;
+} // end
+
+XmlWriter& XmlWriter::attr(std::string_view name, std::string_view value) {
+  if (!_inTag)
+    throw std::logic_error{"XmlWriter::attr: no start tag"};
+  _out += ' ';
+  _out += name;
+  _out += "=\"";
+  AppendEscaped(_out, value);
+  _out += '"';
+  return *this;
+} // attr
+
+XmlWriter& XmlWriter::attr(std::string_view name, int value) {
+  char buf[16];
+  auto r = std::to_chars(buf, buf + sizeof(buf), value);
+  return attr(name, std::string_view{buf, r.ptr});
+} // attr(int)
+
+XmlWriter& XmlWriter::attr(std::string_view name, double value) {
+  // Same as pugixml's default_double_precision "%.17g".
+  char buf[32];
+  auto r = std::to_chars(buf, buf + sizeof(buf), value,
+                         std::chars_format::general, 17);
+  return attr(name, std::string_view{buf, r.ptr});
+} // attr(double)
+
+} // tjg
@@ -0,0 +1,57 @@
+/// @file
+/// Streaming XML emitter.
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+///
+/// Output is byte-identical to pugixml's xml_document::save() with
+/// format_default and the same indent string: one element per line, " />"
+/// for empty elements, attribute values escaped as pugixml does and doubles
+/// written as "%.17g".  Text goes into an internal buffer that the caller
+/// drains whenever convenient, so memory stays bounded by what is pending.
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+namespace tjg {
+
+class XmlWriter {
+  std::string _out;
+  std::string _indent;
+  std::vector<std::string> _open;
+  bool _inTag = false; // start tag written, '>' not yet
+
+  void closeTag();
+  void indent(std::size_t depth);
+
+public:
+  explicit XmlWriter(std::string indent = "  ") : _indent{std::move(indent)} { }
+
+  /// Writes <?xml version="..." encoding="..."?>.
+  XmlWriter& declaration(std::string_view version  = "1.0",
+                         std::string_view encoding = "utf-8");
+
+  XmlWriter& start(std::string_view name);
+  XmlWriter& end();
+
+  /// Attributes apply to the element most recently started.
+  XmlWriter& attr(std::string_view name, std::string_view value);
+  XmlWriter& attr(std::string_view name, const char* value)
+    { return attr(name, std::string_view{value ? value : ""}); }
+  XmlWriter& attr(std::string_view name, int value);
+  XmlWriter& attr(std::string_view name, double value);
+
+  /// Nesting depth; zero once the root element has ended.
+  std::size_t depth() const noexcept { return _open.size(); }
+
+  /// Pending output, ready to be written out.
+  const std::string& buffer() const noexcept { return _out; }
+  const char*  data() const noexcept { return _out.data(); }
+  std::size_t  size() const noexcept { return _out.size(); }
+  void clear() noexcept { _out.clear(); }
+}; // XmlWriter
+
+} // tjg
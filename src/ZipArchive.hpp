@@ -3,10 +3,13 @@
 #include <gsl-lite/gsl-lite.hpp>
 
 #include <filesystem>
+#include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <iostream>
 #include <stdexcept>
+#include <ctime>
 
 namespace farm_db {
 
@@ -40,6 +43,97 @@ class ZipArchive {
 
   [[noreturn]] void dieError(const std::string& msg) { die(msg, getError()); }
 
+public:
+  /// Fills up to `size` bytes of `buf`; returns 0 at end of data.
+  using ReadFn = std::function<std::size_t(void* buf, std::size_t size)>;
+
+  /// The uncompressed size and CRC-32 of a deflated source's data.
+  struct DeflatedStat {
+    zip_uint64_t size = 0;
+    zip_uint32_t crc  = 0;
+  }; // DeflatedStat
+  using DeflatedStatFn = std::function<DeflatedStat()>;
+
+private:
+  // State of a source created by source(ReadFn); owned by libzip.
+  struct CallbackState {
+    ReadFn read;
+    std::time_t mtime = std::time(nullptr);
+    zip_error_t error;
+    bool opened = false;
+    // Set by deflated(): the data is already compressed, and `stat` knows
+    // its size and CRC once `read` has returned 0.
+    DeflatedStatFn stat;
+    zip_uint64_t compSize = 0;
+    bool finished = false;
+    CallbackState(ReadFn read_) : read{std::move(read_)}
+      { zip_error_init(&error); }
+    ~CallbackState() noexcept { zip_error_fini(&error); }
+  }; // CallbackState
+
+  static zip_int64_t Callback(void* state, void* data, zip_uint64_t len,
+                              zip_source_cmd_t cmd) noexcept
+  {
+    auto& cs = *static_cast<CallbackState*>(state);
+    switch (cmd) {
+      case ZIP_SOURCE_OPEN:
+        // The data is produced on the fly and cannot be rewound.
+        if (cs.opened) {
+          zip_error_set(&cs.error, ZIP_ER_OPNOTSUPP, 0);
+          return -1;
+        }
+        cs.opened = true;
+        return 0;
+      case ZIP_SOURCE_READ:
+        try {
+          const auto n = cs.read(data, gsl::narrow<std::size_t>(len));
+          cs.compSize += n;
+          cs.finished = (n == 0);
+          return gsl::narrow<zip_int64_t>(n);
+        }
+        catch (...) {
+          // The reader keeps the exception; libzip only sees an error code.
+          zip_error_set(&cs.error, ZIP_ER_INTERNAL, 0);
+          return -1;
+        }
+      case ZIP_SOURCE_CLOSE:
+        return 0;
+      case ZIP_SOURCE_STAT: {
+        auto st = static_cast<zip_stat_t*>(data);
+        zip_stat_init(st);
+        st->mtime = cs.mtime;
+        st->valid |= ZIP_STAT_MTIME;
+        if (cs.stat) {
+          // libzip copies data whose method matches the entry's unchanged,
+          // and stats the source again after copying it for its size and
+          // CRC, which only then are known.
+          st->comp_method = ZIP_CM_DEFLATE;
+          st->valid |= ZIP_STAT_COMP_METHOD;
+          if (cs.finished) {
+            const auto ds = cs.stat();
+            st->size      = ds.size;
+            st->comp_size = cs.compSize;
+            st->crc       = ds.crc;
+            st->valid |= ZIP_STAT_SIZE | ZIP_STAT_COMP_SIZE | ZIP_STAT_CRC;
+          }
+        }
+        return sizeof(zip_stat_t);
+      }
+      case ZIP_SOURCE_ERROR:
+        return zip_error_to_data(&cs.error, data, len);
+      case ZIP_SOURCE_FREE:
+        delete &cs;
+        return 0;
+      case ZIP_SOURCE_SUPPORTS:
+        return zip_source_make_command_bitmap(ZIP_SOURCE_OPEN,
+                   ZIP_SOURCE_READ, ZIP_SOURCE_CLOSE, ZIP_SOURCE_STAT,
+                   ZIP_SOURCE_ERROR, ZIP_SOURCE_FREE, ZIP_SOURCE_SUPPORTS, -1);
+      default:
+        zip_error_set(&cs.error, ZIP_ER_OPNOTSUPP, 0);
+        return -1;
+    }
+  } // Callback
+
 public:
   class Source {
     ZipArchive*   za = nullptr;
@@ -132,6 +226,12 @@ public:
       if (!zf) dieError("cannot open");
     } // open
 
+    /// `method` is a ZIP_CM_* constant; `level` 0 means its default.
+    void setCompression(zip_int32_t method, zip_uint32_t level=0) {
+      if (zip_set_file_compression(za->za, _index, method, level) != 0)
+        dieError("cannot set compression");
+    } // setCompression
+
     void replace(Source& src, zip_flags_t flags=0) {
       if (zip_file_replace(za->za, _index, src.zs, flags) != 0)
         dieError("cannot replace");
@@ -159,6 +259,10 @@ private:
 
   std::string errorStr() const { return ErrorStr(getError()); }
 
+  /// Whether this libzip can compress with `method`, a ZIP_CM_* constant.
+  static bool CompressionSupported(zip_int32_t method) noexcept
+    { return zip_compression_method_supported(method, 1) != 0; }
+
   const fs::path& name() const { return _name; }
 
   void discard() noexcept { zip_discard(za); za = nullptr; }
@@ -213,9 +317,38 @@ private:
     return Source{*this, zs};
   } // buffer
 
+  /// A source whose data is pulled from `read` while the archive is being
+  /// written by close(), so it need never be held in memory all at once.
+  /// It is read exactly once.  If `read` throws, close() fails; the caller
+  /// is responsible for keeping the exception if it wants to report it.
+  Source source(ReadFn read) {
+    auto state = std::make_unique<CallbackState>(std::move(read));
+    auto zs = zip_source_function(za, Callback, state.get());
+    if (!zs)
+      dieError("cannot create callback source");
+    (void) state.release(); // freed by ZIP_SOURCE_FREE
+    return Source{*this, zs};
+  } // source
+
+  /// A source of a raw deflate stream, pulled from `read` while close()
+  /// writes the archive and copied into a deflated entry as is instead of
+  /// being compressed again.  `stat` gives the uncompressed size and CRC-32
+  /// of the stream once `read` has returned 0.  As with source(ReadFn),
+  /// it is read exactly once.
+  Source deflated(ReadFn read, DeflatedStatFn stat) {
+    auto state = std::make_unique<CallbackState>(std::move(read));
+    state->stat = std::move(stat);
+    auto zs = zip_source_function(za, Callback, state.get());
+    if (!zs)
+      dieError("cannot create deflated source");
+    (void) state.release(); // freed by ZIP_SOURCE_FREE
+    return Source{*this, zs};
+  } // deflated
+
   File addFile(const fs::path& name, Source& src, zip_flags_t flags=0) {
     auto idx = zip_file_add(za, name.string().c_str(), src.zs, flags);
     if (idx < 0) dieError("cannot add `" + name.generic_string() + "'");
+    src.release(); // now owned by the archive
     return File{*this, gsl::narrow<int>(idx)};
   } // addFile
 
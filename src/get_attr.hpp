@@ -1,7 +1,5 @@
 #include "enum_help.hpp"
 
-#include <pugixml.hpp>
-
 #include <string>
 #include <string_view>
 #include <optional>
@@ -15,13 +13,19 @@
 
 namespace tjg {
 
-inline std::string_view name(const pugi::xml_node& n) noexcept
-  { return std::string_view{n.name()}; }
-inline std::string_view value(const pugi::xml_node& n) noexcept
-  { return std::string_view{n.value()}; }
-inline std::string_view name(const pugi::xml_attribute& a) noexcept
+/// Anything that looks like an XML attribute: pugi::xml_attribute, XmlAttr.
+template<class A>
+concept XmlAttribute = requires(const A& a) {
+  { a.name()  } -> std::convertible_to<const char*>;
+  { a.value() } -> std::convertible_to<const char*>;
+  { !a } -> std::convertible_to<bool>;
+};
+
+template<XmlAttribute A>
+inline std::string_view name(const A& a) noexcept
   { return std::string_view{a.name()}; }
-inline std::string_view value(const pugi::xml_attribute& a) noexcept
+template<XmlAttribute A>
+inline std::string_view value(const A& a) noexcept
   { return std::string_view{a.value()}; }
 
 namespace detail {
@@ -50,8 +54,8 @@ concept HasStdFromChars = requires (const char* f, const char* l, T& v) {
 
 } // detail
 
-template<typename T>
-inline std::optional<T> try_get_attr(const pugi::xml_attribute& a) noexcept {
+template<typename T, XmlAttribute A>
+inline std::optional<T> try_get_attr(const A& a) noexcept {
   if (!a) return std::nullopt;
 
   if constexpr (std::is_same_v<T, const char*>)
@@ -160,8 +164,8 @@ inline std::optional<T> try_get_attr(const pugi::xml_attribute& a) noexcept {
   return std::nullopt;
 } // try_get_attr
 
-template<typename T>
-inline T get_attr(const pugi::xml_attribute& a) {
+template<typename T, XmlAttribute A>
+inline T get_attr(const A& a) {
   if (!a) throw std::runtime_error{"get_attr: empty attribute"};
   auto v = try_get_attr<T>(a);
   if (v)
@@ -0,0 +1,76 @@
+/// @file
+/// @copyright 2026 Terry Golubiewski, all rights reserved.
+/// @author Terry Golubiewski
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+namespace tjg {
+
+/// Resolves a requested thread count; zero means one per hardware thread.
+inline int ThreadCount(int threads) noexcept {
+  if (threads > 0)
+    return threads;
+  auto n = static_cast<int>(std::thread::hardware_concurrency());
+  return (n > 0) ? n : 1;
+} // ThreadCount
+
+/// Calls fn(i) for every i in [0, n) on up to `threads` threads.
+/// Indices are handed out in increasing order, so when fn throws, every
+/// lower index has already started; the exception from the lowest failing
+/// index is rethrown once all workers have stopped.  This makes the reported
+/// error independent of thread scheduling.
+template<class F>
+void ParallelFor(std::size_t n, int threads, F&& fn) {
+  const auto nThreads = std::min(static_cast<std::size_t>(ThreadCount(threads)),
+                                 n);
+  if (nThreads <= 1) {
+    for (auto i = std::size_t{0}; i != n; ++i)
+      fn(i);
+    return;
+  }
+
+  auto next   = std::atomic<std::size_t>{0};
+  auto failed = std::atomic<bool>{false};
+  auto mtx    = std::mutex{};
+  auto error  = std::exception_ptr{};
+  auto errIdx = n;
+
+  auto worker = [&] {
+    while (!failed.load(std::memory_order_relaxed)) {
+      const auto i = next.fetch_add(1, std::memory_order_relaxed);
+      if (i >= n)
+        return;
+      try {
+        fn(i);
+      }
+      catch (...) {
+        const auto lock = std::lock_guard{mtx};
+        if (i < errIdx) {
+          errIdx = i;
+          error  = std::current_exception();
+        }
+        failed = true;
+      }
+    }
+  };
+
+  {
+    auto pool = std::vector<std::jthread>{};
+    pool.reserve(nThreads - 1);
+    for (auto t = std::size_t{1}; t != nThreads; ++t)
+      pool.emplace_back(worker);
+    worker();
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+} // ParallelFor
+
+} // tjg